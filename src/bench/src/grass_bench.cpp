@@ -0,0 +1,524 @@
+#include "grass.h"
+#include "common.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace chrono = std::chrono;
+namespace fs = std::filesystem;
+
+#define SCRIPT_DIR "res/bench"
+
+
+/* Every allocation made through operator new, on any thread */
+
+static std::atomic<size_t> g_allocations{ 0 };
+
+
+void* operator new(size_t size)
+{
+    ++g_allocations;
+
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+
+/* Scripts are text files with one step per line, every step takes one or more frames.
+*
+*   open <lines> [length]               generates a file with that many lines of up to length characters and opens it
+*   click <x> <y>                       presses and releases the mouse
+*   type <count> <text>                 types count characters, one per frame, going around text
+*   burst <count> <frames> <text>       types count characters every frame, like key repeat or an ime would
+*   key <return|backspace|left|right|up|down> <count>
+*   wheel <x> <y> <amount> <count>
+*   hwheel <x> <y> <amount> <count>     sideways, positive is to the right
+*   drag <x1> <y1> <x2> <y2> <frames>  presses at the first point and releases at the second
+*   resize <w> <h>
+*   idle <count>                        frames without any input
+*
+* Coordinates are relative to the window, anything after a # is ignored.
+*/
+struct Step
+{
+    std::string command;
+    std::vector<int> args;
+    std::string text;
+};
+
+
+struct Result
+{
+    std::string name;
+
+    std::vector<double> frame_ms;
+    std::vector<double> edit_latency_ms;
+    std::vector<size_t> allocations;
+
+    int presented{ 0 };
+    double total_ms{ 0.0 };
+};
+
+
+std::vector<Step> parse_script(const std::string& fp)
+{
+    std::vector<Step> steps;
+    std::ifstream ifs(fp);
+    std::string line;
+
+    while (std::getline(ifs, line))
+    {
+        line = line.substr(0, line.find('#'));
+
+        std::stringstream ss(line);
+        Step step;
+
+        if (!(ss >> step.command))
+            continue;
+
+        // the text being typed is the rest of the line and can have spaces in it
+        int count;
+
+        if (step.command == "type" || step.command == "burst")
+        {
+            ss >> count;
+            step.args.push_back(count);
+
+            if (step.command == "burst" && ss >> count)
+                step.args.push_back(count);
+
+            std::getline(ss, step.text);
+
+            if (!step.text.empty() && step.text[0] == ' ')
+                step.text.erase(0, 1);
+
+            if (step.text.empty())
+                step.text = "a";
+        }
+        else
+        {
+            if (step.command == "key")
+                ss >> step.text;
+
+            int arg;
+
+            while (ss >> arg)
+                step.args.push_back(arg);
+        }
+
+        steps.emplace_back(std::move(step));
+    }
+
+    return steps;
+}
+
+
+std::string make_file(const fs::path& dir, int lines, int max_length)
+{
+    fs::create_directories(dir);
+    fs::path fp = dir / ("bench_" + std::to_string(lines) + "_" + std::to_string(max_length) + ".txt");
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> line_length(0, max_length);
+
+    std::ofstream ofs(fp, std::ofstream::binary | std::ofstream::trunc);
+
+    for (int i = 0; i < lines; ++i)
+    {
+        std::string line(line_length(rng), ' ');
+
+        for (auto& c : line)
+            c = (char)('a' + rng() % 26);
+
+        ofs << line << '\n';
+    }
+
+    return fp.string();
+}
+
+
+SDL_Keycode key_from_name(const std::string& name)
+{
+    if (name == "return") return SDLK_RETURN;
+    if (name == "backspace") return SDLK_BACKSPACE;
+    if (name == "left") return SDLK_LEFT;
+    if (name == "right") return SDLK_RIGHT;
+    if (name == "up") return SDLK_UP;
+    if (name == "down") return SDLK_DOWN;
+
+    return SDLK_UNKNOWN;
+}
+
+
+/* Plays a script into Grass, one frame at a time */
+class Player
+{
+public:
+    Player(Grass& grass, std::vector<Step> steps, const fs::path& data_dir)
+        : m_grass(grass), m_steps(std::move(steps)), m_data_dir(data_dir) {}
+
+    void before_frame()
+    {
+        m_frame_start = chrono::steady_clock::now();
+        m_frame_allocations = g_allocations;
+
+        if (m_step >= m_steps.size())
+        {
+            if (!m_quit_sent)
+            {
+                SDL_Event evt{};
+                evt.type = SDL_QUIT;
+                SDL_PushEvent(&evt);
+
+                m_quit_sent = true;
+            }
+
+            return;
+        }
+
+        bool edit = play(m_steps[m_step], m_frame);
+
+        if (edit && !m_edit_pending)
+        {
+            m_edit_pending = true;
+            m_edit_start = m_frame_start;
+        }
+
+        ++m_frame;
+
+        if (m_frame >= frames(m_steps[m_step]))
+        {
+            ++m_step;
+            m_frame = 0;
+        }
+    }
+
+    void after_frame(bool presented)
+    {
+        auto now = chrono::steady_clock::now();
+
+        m_result.frame_ms.push_back(chrono::duration<double, std::milli>(now - m_frame_start).count());
+        m_result.allocations.push_back(g_allocations - m_frame_allocations);
+
+        if (presented)
+        {
+            ++m_result.presented;
+
+            // an edit only counts as done once it is on screen
+            if (m_edit_pending)
+            {
+                m_result.edit_latency_ms.push_back(chrono::duration<double, std::milli>(now - m_edit_start).count());
+                m_edit_pending = false;
+            }
+        }
+    }
+
+    Result& result() { return m_result; }
+
+private:
+    static int frames(const Step& step)
+    {
+        auto arg = [&step](size_t i) { return i < step.args.size() ? step.args[i] : 0; };
+
+        if (step.command == "type" || step.command == "idle")
+            return std::max(1, arg(0));
+
+        if (step.command == "key")
+            return std::max(1, arg(0));
+
+        if (step.command == "burst")
+            return std::max(1, arg(1));
+
+        if (step.command == "wheel" || step.command == "hwheel")
+            return std::max(1, arg(3));
+
+        if (step.command == "drag")
+            return std::max(2, arg(4));
+
+        return 1;
+    }
+
+    // pushes the input for one frame of step, returns true if it edits the text
+    bool play(const Step& step, int frame)
+    {
+        auto arg = [&step](size_t i) { return i < step.args.size() ? step.args[i] : 0; };
+
+        if (step.command == "open")
+        {
+            m_grass.open_file(make_file(m_data_dir, arg(0), step.args.size() > 1 ? arg(1) : 100));
+        }
+        else if (step.command == "click")
+        {
+            move_mouse(arg(0), arg(1));
+            push_button(SDL_MOUSEBUTTONDOWN);
+            push_button(SDL_MOUSEBUTTONUP);
+        }
+        else if (step.command == "type")
+        {
+            SDL_Event evt{};
+            evt.type = SDL_TEXTINPUT;
+            evt.text.text[0] = step.text[frame % step.text.size()];
+            SDL_PushEvent(&evt);
+
+            return true;
+        }
+        else if (step.command == "burst")
+        {
+            // every character is its own event, it is up to grass to put them together
+            for (int i = 0; i < arg(0); ++i)
+            {
+                SDL_Event evt{};
+                evt.type = SDL_TEXTINPUT;
+                evt.text.text[0] = step.text[(frame * arg(0) + i) % step.text.size()];
+                SDL_PushEvent(&evt);
+            }
+
+            return true;
+        }
+        else if (step.command == "key")
+        {
+            SDL_Keycode key = key_from_name(step.text);
+
+            SDL_Event evt{};
+            evt.type = SDL_KEYDOWN;
+            evt.key.keysym.sym = key;
+            evt.key.keysym.scancode = SDL_GetScancodeFromKey(key);
+            SDL_PushEvent(&evt);
+
+            evt.type = SDL_KEYUP;
+            SDL_PushEvent(&evt);
+
+            return key == SDLK_RETURN || key == SDLK_BACKSPACE;
+        }
+        else if (step.command == "wheel")
+        {
+            move_mouse(arg(0), arg(1));
+
+            SDL_Event evt{};
+            evt.type = SDL_MOUSEWHEEL;
+            evt.wheel.y = arg(2);
+            SDL_PushEvent(&evt);
+        }
+        else if (step.command == "hwheel")
+        {
+            move_mouse(arg(0), arg(1));
+
+            SDL_Event evt{};
+            evt.type = SDL_MOUSEWHEEL;
+            evt.wheel.x = arg(2);
+            SDL_PushEvent(&evt);
+        }
+        else if (step.command == "drag")
+        {
+            int last = frames(step) - 1;
+
+            move_mouse(arg(0) + (arg(2) - arg(0)) * frame / last, arg(1) + (arg(3) - arg(1)) * frame / last);
+
+            if (frame == 0)
+                push_button(SDL_MOUSEBUTTONDOWN);
+            else if (frame == last)
+                push_button(SDL_MOUSEBUTTONUP);
+            else
+                gui::common::wake_main_loop();
+        }
+        else if (step.command == "resize")
+        {
+            SDL_SetWindowSize(m_grass.window(), arg(0), arg(1));
+            gui::common::wake_main_loop();
+        }
+        else
+        {
+            // idle, the loop still has to run once to be measured
+            gui::common::wake_main_loop();
+        }
+
+        return false;
+    }
+
+    void move_mouse(int x, int y)
+    {
+        // grass reads the global mouse position, which the dummy driver reports relative to the window
+        int wx, wy;
+        SDL_GetWindowPosition(m_grass.window(), &wx, &wy);
+
+        SDL_WarpMouseInWindow(m_grass.window(), x + wx, y + wy);
+    }
+
+    void push_button(Uint32 type)
+    {
+        SDL_Event evt{};
+        evt.type = type;
+        evt.button.button = SDL_BUTTON_LEFT;
+        SDL_PushEvent(&evt);
+    }
+
+private:
+    Grass& m_grass;
+
+    std::vector<Step> m_steps;
+    size_t m_step{ 0 };
+    int m_frame{ 0 };
+
+    fs::path m_data_dir;
+
+    chrono::steady_clock::time_point m_frame_start;
+    size_t m_frame_allocations{ 0 };
+
+    bool m_edit_pending{ false };
+    chrono::steady_clock::time_point m_edit_start;
+
+    bool m_quit_sent{ false };
+
+    Result m_result;
+};
+
+
+template <typename T>
+double percentile(std::vector<T> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+
+    std::sort(values.begin(), values.end());
+    return (double)values[(size_t)((values.size() - 1) * p)];
+}
+
+
+template <typename T>
+double mean(const std::vector<T>& values)
+{
+    if (values.empty())
+        return 0.0;
+
+    double sum = 0.0;
+
+    for (auto v : values)
+        sum += (double)v;
+
+    return sum / values.size();
+}
+
+
+template <typename T>
+void write_stats(std::ostream& os, const std::vector<T>& values)
+{
+    os << "{ \"count\": " << values.size()
+        << ", \"mean\": " << mean(values)
+        << ", \"p50\": " << percentile(values, 0.5)
+        << ", \"p99\": " << percentile(values, 0.99)
+        << ", \"max\": " << percentile(values, 1.0) << " }";
+}
+
+
+Result run(const std::string& script, const fs::path& data_dir)
+{
+    Grass grass;
+    Player player(grass, parse_script(script), data_dir);
+
+    grass.set_frame_hooks(
+        [&player]() { player.before_frame(); },
+        [&player](bool presented) { player.after_frame(presented); }
+    );
+
+    auto start = chrono::steady_clock::now();
+    grass.mainloop();
+
+    Result result = std::move(player.result());
+    result.name = fs::path(script).stem().string();
+    result.total_ms = chrono::duration<double, std::milli>(chrono::steady_clock::now() - start).count();
+
+    return result;
+}
+
+
+/* Usage: grass_bench [script...]
+* Runs every script in res/bench if none are given, from the directory grass is normally run from.
+* Prints the results as json to stdout so they can be compared between commits.
+*/
+int main(int argc, char** argv)
+{
+    // no window, no gpu, no sound
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+
+    std::vector<std::string> scripts(argv + 1, argv + argc);
+
+    if (scripts.empty())
+    {
+        std::error_code ec;
+
+        for (auto& entry : fs::directory_iterator(SCRIPT_DIR, ec))
+        {
+            if (entry.path().extension() == ".txt")
+                scripts.push_back(entry.path().string());
+        }
+
+        std::sort(scripts.begin(), scripts.end());
+    }
+
+    if (scripts.empty())
+    {
+        std::cerr << "no scripts found in " SCRIPT_DIR "\n";
+        return 1;
+    }
+
+    fs::path data_dir = fs::temp_directory_path() / "grass_bench";
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "{\n  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < scripts.size(); ++i)
+    {
+        std::cerr << "running " << scripts[i] << "\n";
+
+        Result result = run(scripts[i], data_dir);
+
+        std::cout << "    {\n"
+            << "      \"script\": \"" << result.name << "\",\n"
+            << "      \"frames\": " << result.frame_ms.size() << ",\n"
+            << "      \"presented_frames\": " << result.presented << ",\n"
+            << "      \"total_ms\": " << result.total_ms << ",\n";
+
+        std::cout << "      \"frame_ms\": ";
+        write_stats(std::cout, result.frame_ms);
+        std::cout << ",\n      \"edit_latency_ms\": ";
+        write_stats(std::cout, result.edit_latency_ms);
+        std::cout << ",\n      \"allocations_per_frame\": ";
+        write_stats(std::cout, result.allocations);
+
+        std::cout << "\n    }" << (i + 1 < scripts.size() ? "," : "") << "\n";
+    }
+
+    std::cout << "  ]\n}\n";
+
+    std::error_code ec;
+    fs::remove_all(data_dir, ec);
+
+    return 0;
+}
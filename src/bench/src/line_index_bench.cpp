@@ -0,0 +1,109 @@
+#include "line_index.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <random>
+#include <string>
+
+namespace chrono = std::chrono;
+namespace line_index = gui::line_index;
+
+#define BUFFER_SIZE (256 * 1024 * 1024)
+#define RUNS 3
+
+
+std::string make_buffer(int min_line, int max_line)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> line_length(min_line, max_line);
+
+    std::string s;
+    s.reserve(BUFFER_SIZE);
+
+    while (s.size() < BUFFER_SIZE)
+    {
+        int length = line_length(rng);
+
+        for (int i = 0; i < length; ++i)
+            s += (char)('a' + rng() % 26);
+
+        s += '\n';
+    }
+
+    s.resize(BUFFER_SIZE);
+    return s;
+}
+
+
+// best of RUNS in GB/s
+double gb_per_second(size_t bytes, const std::function<void()>& func)
+{
+    double best = 0.0;
+
+    for (int i = 0; i < RUNS; ++i)
+    {
+        auto start = chrono::steady_clock::now();
+        func();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        best = std::max(best, bytes / seconds / 1e9);
+    }
+
+    return best;
+}
+
+
+void run(const std::string& name, const std::string& buffer)
+{
+    struct Impl { const char* name; line_index::Implementation impl; };
+
+    std::vector<Impl> impls = { { "scalar", line_index::Implementation::SCALAR } };
+
+    if (line_index::best_implementation() >= line_index::Implementation::SSE2)
+        impls.push_back({ "sse2", line_index::Implementation::SSE2 });
+
+    if (line_index::best_implementation() >= line_index::Implementation::AVX2)
+        impls.push_back({ "avx2", line_index::Implementation::AVX2 });
+
+    size_t expected = line_index::count_new_lines(buffer.data(), buffer.size(), line_index::Implementation::SCALAR);
+
+    std::cout << name << ": " << buffer.size() / (1024 * 1024) << " MB, " << expected << " lines\n";
+
+    for (auto& impl : impls)
+    {
+        size_t count = 0;
+        double count_speed = gb_per_second(buffer.size(), [&]() {
+            count = line_index::count_new_lines(buffer.data(), buffer.size(), impl.impl);
+        });
+
+        std::vector<size_t> starts;
+        double find_speed = gb_per_second(buffer.size(), [&]() {
+            starts.clear();
+            line_index::find_line_starts(buffer.data(), buffer.size(), 0, starts, impl.impl);
+        });
+
+        std::cout << "  " << std::left << std::setw(10) << impl.name << std::right << std::fixed << std::setprecision(2)
+            << "count " << std::setw(7) << count_speed << " GB/s   find " << std::setw(7) << find_speed << " GB/s"
+            << (count == expected && starts.size() == expected ? "" : "   MISMATCH") << "\n";
+    }
+
+    std::vector<size_t> starts;
+    double parallel_speed = gb_per_second(buffer.size(), [&]() {
+        starts.clear();
+        line_index::find_line_starts_parallel(buffer.data(), buffer.size(), 0, starts);
+    });
+
+    std::cout << "  " << std::left << std::setw(10) << "parallel" << std::right << std::fixed << std::setprecision(2)
+        << "                   find " << std::setw(7) << parallel_speed << " GB/s"
+        << (starts.size() == expected ? "" : "   MISMATCH") << "\n\n";
+}
+
+
+int main(int argc, char** argv)
+{
+    run("short lines (0-20 chars)", make_buffer(0, 20));
+    run("long lines (500-1500 chars)", make_buffer(500, 1500));
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include "path_index.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace chrono = std::chrono;
+namespace fs = std::filesystem;
+
+#define DEFAULT_PATHS 500000
+#define FILES_PER_FOLDER 500
+#define RUNS 3
+// a frame at 60 fps, every keystroke should have its results by then
+#define TARGET_MS 16.0
+
+
+const char* g_words[] = {
+    "render", "text", "buffer", "folder", "index", "line", "search", "panel", "cursor", "view",
+    "file", "tree", "scan", "watch", "journal", "save", "load", "font", "glyph", "cache"
+};
+
+const char* g_extensions[] = { ".cpp", ".h", ".txt", ".md", ".json", ".py" };
+
+
+std::string word(std::mt19937& rng)
+{
+    return g_words[rng() % (sizeof(g_words) / sizeof(g_words[0]))];
+}
+
+
+// fills dir with count empty files with source looking names, a few folders deep
+void make_tree(const fs::path& dir, size_t count)
+{
+    std::mt19937 rng(42);
+    fs::path folder;
+
+    for (size_t file = 0; file < count; ++file)
+    {
+        if (file % FILES_PER_FOLDER == 0)
+        {
+            size_t n = file / FILES_PER_FOLDER;
+            folder = dir / ("module_" + std::to_string(n / 20)) / (word(rng) + "_" + std::to_string(n % 20));
+
+            fs::create_directories(folder);
+        }
+
+        std::string name = word(rng) + "_" + word(rng);
+
+        // some camel case ones too
+        if (rng() % 3 == 0)
+        {
+            std::string second = word(rng);
+            second[0] = (char)(second[0] - 'a' + 'A');
+            name = word(rng) + second;
+        }
+
+        name += "_" + std::to_string(file) + g_extensions[rng() % (sizeof(g_extensions) / sizeof(g_extensions[0]))];
+        std::ofstream(folder / name);
+    }
+}
+
+
+// calls update until results for query come back, returns how long that took
+double wait_for(gui::PathIndex& index, const std::string& query, gui::PathIndex::Results& results)
+{
+    // results come back for the lowercase query
+    std::string lowered = query;
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+
+    auto start = chrono::steady_clock::now();
+    index.search(query);
+
+    while (!index.take_results(results) || results.query != lowered)
+    {
+        index.update();
+        std::this_thread::sleep_for(chrono::microseconds(50));
+    }
+
+    return chrono::duration<double, std::milli>(chrono::steady_clock::now() - start).count();
+}
+
+
+// listing everything under root, until every path can be searched
+double bench_build(gui::PathIndex& index, const std::string& root, size_t count)
+{
+    gui::PathIndex::Results results;
+
+    auto start = chrono::steady_clock::now();
+    index.build(root);
+
+    while (index.building())
+    {
+        index.update();
+        std::this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    // the last paths can still be on their way to the search thread, the same query twice wouldnt be searched again
+    for (int i = 0; results.total < count; ++i)
+        wait_for(index, i % 2 ? "a" : "b", results);
+
+    double ms = chrono::duration<double, std::milli>(chrono::steady_clock::now() - start).count();
+
+    std::cout << "build   " << std::fixed << std::setprecision(1) << std::setw(9) << ms << " ms   " << results.total << " paths\n\n";
+
+    return ms;
+}
+
+
+// every prefix of query typed one character at a time, the way it is typed into quick open
+void bench_typing(gui::PathIndex& index, const std::string& query)
+{
+    double worst = 0.0;
+    double total = 0.0;
+    size_t matched = 0;
+    gui::PathIndex::Results results;
+
+    for (int run = 0; run < RUNS; ++run)
+    {
+        wait_for(index, "", results);
+
+        for (size_t i = 1; i <= query.size(); ++i)
+        {
+            double ms = wait_for(index, query.substr(0, i), results);
+
+            worst = std::max(worst, ms);
+            total += ms;
+            matched = results.matched;
+        }
+    }
+
+    std::cout << "  typed " << std::left << std::setw(18) << query << std::right << std::fixed << std::setprecision(2)
+        << "worst " << std::setw(7) << worst << " ms   mean " << std::setw(7) << total / (RUNS * query.size()) << " ms   "
+        << matched << " matches" << (worst > TARGET_MS ? "   OVER TARGET" : "") << "\n";
+}
+
+
+// a query that has nothing to do with the last one, so every path is looked at again
+void bench_fresh(gui::PathIndex& index, const std::string& query)
+{
+    double best = 1e30;
+    double worst = 0.0;
+    gui::PathIndex::Results results;
+
+    for (int run = 0; run < RUNS; ++run)
+    {
+        wait_for(index, "", results);
+
+        double ms = wait_for(index, query, results);
+
+        best = std::min(best, ms);
+        worst = std::max(worst, ms);
+    }
+
+    std::cout << "  fresh " << std::left << std::setw(18) << query << std::right << std::fixed << std::setprecision(2)
+        << "worst " << std::setw(7) << worst << " ms   best " << std::setw(7) << best << " ms   "
+        << results.matched << " matches" << (worst > TARGET_MS ? "   OVER TARGET" : "") << "\n";
+}
+
+
+/* Usage: path_index_bench [paths] [--keep]
+* Generates a tree of empty files in the temp directory, 500k of them by default, lists it into a PathIndex
+* and times how long each query takes to come back, on every thread the index uses.
+* With --keep the tree is left for the next run, which reuses it if it has the same number of files.
+*/
+int main(int argc, char** argv)
+{
+    size_t count = DEFAULT_PATHS;
+    bool keep = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--keep")
+            keep = true;
+        else
+            count = std::stoul(argv[i]);
+    }
+
+    fs::path dir = fs::temp_directory_path() / "grass_path_index_bench";
+    // next to the tree, anything inside of it would be indexed too
+    fs::path marker = dir.string() + ".count";
+
+    size_t existing = 0;
+
+    if (std::ifstream(marker) >> existing && existing == count)
+    {
+        std::cout << "reusing " << dir.string() << "\n\n";
+    }
+    else
+    {
+        std::cout << "generating " << count << " files in " << dir.string() << "\n\n";
+
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+
+        make_tree(dir, count);
+        std::ofstream(marker) << count;
+    }
+
+    gui::PathIndex index;
+    bench_build(index, dir.string(), count);
+
+    std::cout << "latency, target " << TARGET_MS << " ms\n";
+
+    for (const char* query : { "rendbuf", "module_3/scan", "glyphcache.h", "TextView" })
+        bench_typing(index, query);
+
+    for (const char* query : { "e", "zzz", "fldr_idx", "watch_save_9.py" })
+        bench_fresh(index, query);
+
+    if (!keep)
+    {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+        fs::remove(marker, ec);
+    }
+
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include "project_search.h"
+#include "text_search.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace chrono = std::chrono;
+namespace fs = std::filesystem;
+namespace line_index = gui::line_index;
+
+#define DEFAULT_TREE_MB 1024
+#define FILES_PER_FOLDER 100
+#define RUNS 3
+// planted once in every NEEDLE_EVERY text files, and in every binary file and backup, which shouldnt be found
+#define NEEDLE "grass_needle_7f3a"
+#define NEEDLE_EVERY 50
+
+
+const char* g_words[] = {
+    "value", "return", "const", "std::string", "render", "folder", "index", "size_t", "auto", "if",
+    "while", "for", "struct", "namespace", "gui", "text", "line", "buffer", "count", "the"
+};
+
+
+std::string make_text(std::mt19937& rng, size_t size)
+{
+    std::string s;
+    s.reserve(size + 64);
+
+    while (s.size() < size)
+    {
+        int indent = rng() % 4;
+        s.append(indent * 4, ' ');
+
+        int words = 2 + rng() % 10;
+
+        for (int i = 0; i < words; ++i)
+        {
+            s += g_words[rng() % (sizeof(g_words) / sizeof(g_words[0]))];
+            s += ' ';
+        }
+
+        s.back() = '\n';
+    }
+
+    return s;
+}
+
+
+void plant(std::mt19937& rng, std::string& s)
+{
+    size_t at = s.find('\n', rng() % s.size());
+    s.insert(at == std::string::npos ? s.size() : at, " " NEEDLE);
+}
+
+
+/* Fills dir with about mb megabytes of source looking files, most of them small and a few of them big enough to be mapped.
+* Returns how many times NEEDLE should be found.
+*/
+size_t make_tree(const fs::path& dir, size_t mb)
+{
+    std::mt19937 rng(42);
+
+    size_t total = 0;
+    size_t expected = 0;
+
+    for (size_t file = 0; total < mb * 1024 * 1024; ++file)
+    {
+        fs::path folder = dir / ("folder_" + std::to_string(file / (FILES_PER_FOLDER * 10))) / ("sub_" + std::to_string(file / FILES_PER_FOLDER % 10));
+
+        if (file % FILES_PER_FOLDER == 0)
+            fs::create_directories(folder);
+
+        size_t size = file % 20 == 0 ? (1 << 20) + rng() % (3 << 20) : 2048 + rng() % (126 * 1024);
+        std::string text = make_text(rng, size);
+
+        if (file % NEEDLE_EVERY == 0)
+        {
+            plant(rng, text);
+            ++expected;
+        }
+
+        std::ofstream(folder / ("file_" + std::to_string(file) + ".cpp"), std::ios::binary) << text;
+        total += text.size();
+
+        // neither of these should show up in the results
+        if (file % 200 == 0)
+        {
+            std::string binary = text.substr(0, 4096);
+            binary[100] = '\0';
+            plant(rng, binary);
+
+            std::ofstream(folder / ("data_" + std::to_string(file) + ".bin"), std::ios::binary) << binary;
+            std::ofstream(folder / ("file_" + std::to_string(file) + ".cpp~"), std::ios::binary) << text;
+        }
+    }
+
+    return expected;
+}
+
+
+struct Run
+{
+    double first_ms;
+    double total_ms;
+    size_t matches;
+    size_t files;
+    size_t bytes;
+    bool truncated;
+};
+
+
+Run run_search(gui::ProjectSearch& search, const std::string& root, const std::string& query)
+{
+    Run run{ -1.0, 0.0, 0, 0, 0, false };
+    std::vector<gui::ProjectSearch::Match> matches;
+
+    auto start = chrono::steady_clock::now();
+    search.start(root, query);
+
+    while (true)
+    {
+        bool searching = search.searching();
+
+        if (search.take(matches) && run.first_ms < 0.0)
+            run.first_ms = chrono::duration<double, std::milli>(chrono::steady_clock::now() - start).count();
+
+        if (!searching)
+            break;
+
+        std::this_thread::sleep_for(chrono::microseconds(200));
+    }
+
+    run.total_ms = chrono::duration<double, std::milli>(chrono::steady_clock::now() - start).count();
+    run.matches = matches.size();
+    run.files = search.files_searched();
+    run.bytes = search.bytes_searched();
+    run.truncated = search.truncated();
+
+    return run;
+}
+
+
+// best of RUNS in GB/s
+double gb_per_second(size_t bytes, const std::function<void()>& func)
+{
+    double best = 0.0;
+
+    for (int i = 0; i < RUNS; ++i)
+    {
+        auto start = chrono::steady_clock::now();
+        func();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        best = std::max(best, bytes / seconds / 1e9);
+    }
+
+    return best;
+}
+
+
+void bench_find()
+{
+    std::mt19937 rng(7);
+    std::string buffer = make_text(rng, 256 * 1024 * 1024);
+
+    struct Impl { const char* name; line_index::Implementation impl; };
+
+    std::vector<Impl> impls = { { "scalar", line_index::Implementation::SCALAR } };
+
+    if (line_index::best_implementation() >= line_index::Implementation::SSE2)
+        impls.push_back({ "sse2", line_index::Implementation::SSE2 });
+
+    if (line_index::best_implementation() >= line_index::Implementation::AVX2)
+        impls.push_back({ "avx2", line_index::Implementation::AVX2 });
+
+    std::cout << "find in " << buffer.size() / (1024 * 1024) << " MB of text\n";
+
+    // the first one starts with a character that is everywhere, the second with one that is nowhere
+    for (const char* needle : { "return_missing", "QQ_missing" })
+    {
+        std::cout << "  " << needle << "\n";
+
+        for (auto& impl : impls)
+        {
+            size_t found = 0;
+            double speed = gb_per_second(buffer.size(), [&]() {
+                found = gui::text_search::find(buffer.data(), buffer.size(), needle, impl.impl);
+            });
+
+            std::cout << "    " << std::left << std::setw(10) << impl.name << std::right << std::fixed << std::setprecision(2)
+                << std::setw(7) << speed << " GB/s" << (found == gui::text_search::npos ? "" : "   WRONG") << "\n";
+        }
+    }
+
+    std::cout << "\n";
+}
+
+
+void bench_tree(const std::string& root, size_t expected, int threads)
+{
+    gui::ProjectSearch search(threads);
+
+    std::cout << "tree, " << (threads ? std::to_string(threads) : "default") << " threads\n";
+
+    for (const char* query : { NEEDLE, "nothing_has_this", "std::string" })
+    {
+        Run best{ -1.0, 1e30, 0, 0, 0, false };
+
+        for (int i = 0; i < RUNS; ++i)
+        {
+            Run run = run_search(search, root, query);
+
+            if (run.total_ms < best.total_ms)
+                best = run;
+        }
+
+        std::cout << "  " << std::left << std::setw(20) << query << std::right << std::fixed << std::setprecision(1)
+            << std::setw(9) << best.total_ms << " ms   first " << std::setw(7) << best.first_ms << " ms   "
+            << std::setprecision(2) << std::setw(6) << best.bytes / (best.total_ms / 1000.0) / 1e9 << " GB/s   "
+            << best.files << " files   " << best.matches << " matches" << (best.truncated ? " (stopped)" : "");
+
+        if (std::string(query) == NEEDLE && best.matches != expected)
+            std::cout << "   MISMATCH, expected " << expected;
+
+        std::cout << "\n";
+    }
+
+    std::cout << "\n";
+}
+
+
+/* Usage: project_search_bench [megabytes] [--keep]
+* Generates a tree of source looking files in the temp directory, 1 GB of them by default, and searches it.
+* The page cache is warm after the first run, so this measures searching, not the disk.
+* With --keep the tree is left for the next run, which reuses it if it is the same size.
+*/
+int main(int argc, char** argv)
+{
+    size_t mb = DEFAULT_TREE_MB;
+    bool keep = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--keep")
+            keep = true;
+        else
+            mb = std::stoul(argv[i]);
+    }
+
+    bench_find();
+
+    fs::path dir = fs::temp_directory_path() / "grass_search_bench";
+    fs::path marker = dir / ".size";
+
+    size_t expected = 0;
+    size_t existing_mb = 0;
+
+    if (std::ifstream(marker) >> existing_mb >> expected && existing_mb == mb)
+    {
+        std::cout << "reusing " << dir.string() << "\n\n";
+    }
+    else
+    {
+        std::cout << "generating " << mb << " MB in " << dir.string() << "\n\n";
+
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+
+        expected = make_tree(dir, mb);
+        std::ofstream(marker) << mb << " " << expected;
+    }
+
+    bench_tree(dir.string(), expected, 1);
+    bench_tree(dir.string(), expected, 0);
+
+    if (!keep)
+    {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    return 0;
+}
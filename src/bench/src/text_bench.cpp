@@ -0,0 +1,155 @@
+#include "text.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <random>
+
+namespace chrono = std::chrono;
+
+#define LINE_COUNT 200000
+#define EDIT_COUNT 2000
+
+
+// the document model gui::Text used before the piece table, kept here to compare against
+class VectorText
+{
+public:
+    explicit VectorText(const std::vector<std::string>& lines)
+        : m_contents(lines) {}
+
+    void insert(int x, int y, char c)
+    {
+        if (c == '\n')
+        {
+            m_contents.insert(m_contents.begin() + y + 1, m_contents[y].substr(x));
+            m_contents[y].erase(x);
+        }
+        else
+        {
+            m_contents[y].insert(m_contents[y].begin() + x, c);
+        }
+    }
+
+    void join_line(int i)
+    {
+        m_contents[i].append(m_contents[i + 1]);
+        m_contents.erase(m_contents.begin() + i + 1);
+    }
+
+    std::string get_line(int i) const { return m_contents[i]; }
+
+private:
+    std::vector<std::string> m_contents;
+};
+
+
+double time_ms(const std::function<void()>& func)
+{
+    auto start = chrono::steady_clock::now();
+    func();
+
+    return chrono::duration<double, std::milli>(chrono::steady_clock::now() - start).count();
+}
+
+
+void report(const std::string& name, double vector_ms, double piece_ms, int ops)
+{
+    std::cout << std::left << std::setw(28) << name
+        << std::right << std::setw(14) << std::fixed << std::setprecision(3) << vector_ms
+        << std::setw(14) << piece_ms
+        << std::setw(14) << vector_ms * 1000.0 / ops
+        << std::setw(14) << piece_ms * 1000.0 / ops << "\n";
+}
+
+
+int main(int argc, char** argv)
+{
+    std::mt19937 rng(1234);
+
+    std::vector<std::string> lines;
+    std::string joined;
+
+    for (int i = 0; i < LINE_COUNT; ++i)
+    {
+        std::string line = "    generated_value_" + std::to_string(i) + " = compute(" + std::to_string(rng() % 100000) + ");";
+        joined += line + '\n';
+        lines.emplace_back(std::move(line));
+    }
+
+    std::cout << LINE_COUNT << " lines, " << joined.size() << " bytes, " << EDIT_COUNT << " edits per test\n\n";
+    std::cout << std::left << std::setw(28) << "test"
+        << std::right << std::setw(14) << "vector ms" << std::setw(14) << "piece ms"
+        << std::setw(14) << "vector us/op" << std::setw(14) << "piece us/op" << "\n";
+
+    VectorText* vec = nullptr;
+    gui::Text* text = nullptr;
+
+    double vec_ms = time_ms([&]() { vec = new VectorText(lines); });
+    double piece_ms = time_ms([&]() { text = new gui::Text(nullptr, { 0, 0 }, joined, { 0, 0 }, { 255, 255, 255 }); });
+    report("load", vec_ms, piece_ms, 1);
+
+    // pressing enter near the top of the file
+    vec_ms = time_ms([&]() {
+        for (int i = 0; i < EDIT_COUNT; ++i)
+            vec->insert(4, 10, '\n');
+    });
+
+    piece_ms = time_ms([&]() {
+        for (int i = 0; i < EDIT_COUNT; ++i)
+            text->insert(4, 10, '\n');
+    });
+
+    report("enter near top", vec_ms, piece_ms, EDIT_COUNT);
+
+    // backspacing those lines away again
+    vec_ms = time_ms([&]() {
+        for (int i = 0; i < EDIT_COUNT; ++i)
+            vec->join_line(10);
+    });
+
+    piece_ms = time_ms([&]() {
+        for (int i = 0; i < EDIT_COUNT; ++i)
+            text->join_line(10);
+    });
+
+    report("backspace line near top", vec_ms, piece_ms, EDIT_COUNT);
+
+    // typing in the middle of the file
+    vec_ms = time_ms([&]() {
+        for (int i = 0; i < EDIT_COUNT; ++i)
+            vec->insert(4 + i % 10, LINE_COUNT / 2, 'a');
+    });
+
+    piece_ms = time_ms([&]() {
+        for (int i = 0; i < EDIT_COUNT; ++i)
+            text->insert(4 + i % 10, LINE_COUNT / 2, 'a');
+    });
+
+    report("typing in middle", vec_ms, piece_ms, EDIT_COUNT);
+
+    // fetching random lines, what rendering does
+    size_t checksum = 0;
+    std::vector<int> indices(EDIT_COUNT * 10);
+
+    for (auto& i : indices)
+        i = rng() % LINE_COUNT;
+
+    vec_ms = time_ms([&]() {
+        for (int i : indices)
+            checksum += vec->get_line(i).size();
+    });
+
+    piece_ms = time_ms([&]() {
+        for (int i : indices)
+            checksum -= text->get_line(i).size();
+    });
+
+    report("get_line random", vec_ms, piece_ms, (int)indices.size());
+
+    delete vec;
+    delete text;
+
+    // both models should have ended up with the same document
+    return checksum == 0 ? 0 : 1;
+}
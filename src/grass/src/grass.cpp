@@ -3,16 +3,30 @@
 #include "button.h"
 #include "file_tree.h"
 #include "text_entry.h"
-#include "explorer.h"
 #include "scrollbar.h"
+#include "quick_open.h"
+#include "search_panel.h"
+#include "folder_picker.h"
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
 #include <SDL_image.h>
 
 #define BG_COLOR 30, 30, 30
 
+// files at least this big are memory mapped and shown read only until they are modified
+#define MAPPED_FILE_THRESHOLD (64 * 1024 * 1024)
+// how much of a mapped file to search for new lines every frame
+#define INDEX_BYTES_PER_FRAME (16 * 1024 * 1024)
+// how long a status message stays up after it last changed, in ms
+#define STATUS_DURATION 3000
+// how often to update while dragging with the mouse, in ms
+#define DRAG_FRAME_TIME 16
+// characters moved per notch when scrolling sideways
+#define HORIZONTAL_SCROLL_SPEED 4
+
 namespace fs = std::filesystem;
 
 
@@ -64,23 +78,31 @@ void Grass::mainloop()
     std::vector<gui::TextEntry> text_entries;
     text_entries.emplace_back(gui::TextEntry(main_text_dimensions, { 50, 50, 50 }, gui::Cursor({ main_text_dimensions.x, main_text_dimensions.y }, { 255, 255, 255 }, font_textbox.char_dim()), gui::Text(font_textbox.font(), { main_text_dimensions.x, main_text_dimensions.y }, "", font_textbox.char_dim(), { 255, 255, 255 })));
 
+    text_entries[0].text()->set_journal(&m_journal);
+
     std::vector<gui::Button> buttons;
 
-    gui::Folder folder(".", gui::Text(font_tree.font(), { 0, 60 }, "", font_tree.char_dim(), { 255, 255, 255 }), m_rend, true);
+    // listed in the background by the tree
+    gui::Folder folder(".", "");
     gui::Tree tree(
         { 0, main_text_dimensions.y, main_text_dimensions.x, 800 - main_text_dimensions.y },
         folder,
         // when changing font size make sure to also change the 20 below to the y value of the char dimensions specified above
         { 0, main_text_dimensions.y, 200, font_tree.char_dim().y },
+        font_tree,
         m_rend
     );
 
-    for (auto& f : tree.folder().folders())
-    {
-        f.collapse(m_rend);
-    }
+    // ctrl+p, indexes the folder in the background from the start
+    gui::QuickOpen quick_open(font_tree);
+    quick_open.set_root(".");
+
+    // ctrl+shift+f
+    gui::SearchPanel search_panel(font_tree);
+    search_panel.set_root(".");
 
-    tree.update_display();
+    // ctrl+o
+    gui::FolderPicker folder_picker(font_tree);
 
     gui::Scrollbar scrollbar({
         main_text_dimensions.x + main_text_dimensions.w,
@@ -107,8 +129,226 @@ void Grass::mainloop()
     bool mouse_down = false;
     bool ctrl_down = false;
 
+    // set when something the widgets dont know about changes what is on screen
+    bool redraw = true;
+    // a mapped file is still being searched for new lines
+    bool indexing = false;
+
+    // shown in the top right, mostly for saving
+    std::string status;
+    std::unique_ptr<SDL_Texture, gui::common::TextureDeleter> status_tex;
+    Uint32 status_time = 0;
+    bool status_shown = false;
+
+    auto set_status = [&](const std::string& text) {
+        status_time = SDL_GetTicks();
+
+        if (text == status)
+            return;
+
+        status = text;
+        status_tex = std::unique_ptr<SDL_Texture, gui::common::TextureDeleter>(gui::common::render_text(m_rend, font_tree.font(), status.c_str()));
+        redraw = true;
+    };
+
+    // version of the text being saved, the file only counts as saved if it wasnt edited while saving
+    size_t saving_version = 0;
+
+    // called once a save is done, until then the file stays unsaved in case the save fails
+    auto save_finished = [&]() {
+        // the backup only forgets the saved edits once they are really on disk
+        if (m_saver.path() == current_open_fp)
+            m_journal.save_finished(m_saver.succeeded());
+
+        if (!m_saver.succeeded())
+        {
+            set_status("Failed to save " + fs::path(m_saver.path()).filename().string() + ": " + m_saver.error());
+            return;
+        }
+
+        set_status("Saved " + fs::path(m_saver.path()).filename().string());
+
+        if (m_saver.path() == current_open_fp && text_entries[0].text()->version() == saving_version)
+            tree.erase_unsaved_file(current_open_fp, m_window);
+    };
+
+    // waits for the save in progress, so its result is handled while the file it is for is still open
+    auto finish_save = [&]() {
+        m_saver.finish();
+
+        if (m_saver.poll())
+            save_finished();
+    };
+
+    auto open_path = [&](const std::string& fp) {
+        finish_save();
+
+        // the unsaved edits are already in the journal, only the last few might not be written yet
+        m_journal.close();
+
+        text_entries[0].stop_highlight();
+
+        current_open_fp = fp;
+        std::string ext = fs::path(current_open_fp).extension().string();
+
+        if (ext == ".png" || ext == ".jpg" || ext == ".bmp" || ext == ".jpeg" || ext == ".webp")
+        {
+            editor_image = IMG_LoadTexture(m_rend, current_open_fp.c_str());
+
+            if (!editor_image)
+                editor_image = gui::common::render_text(m_rend, font_textbox.font(), SDL_GetError());
+
+            m_loader.cancel();
+            text_entries[0].text()->set_contents({ "" });
+            reset_entry_to_default(text_entries[0]);
+            text_entries[0].hide();
+            scrollbar.hide();
+        }
+        else
+        {
+            if (editor_image)
+                SDL_DestroyTexture(editor_image);
+
+            editor_image = nullptr;
+
+            text_entries[0].show();
+            scrollbar.show();
+            
+            load_file(current_open_fp, text_entries[0]);
+            m_journal.open(current_open_fp);
+
+            if (fs::exists(gui::Journal::journal_path(current_open_fp)))
+            {
+                // the journal is relative to the whole file
+                m_loader.finish(*text_entries[0].text());
+
+                // the recovered edits arent on disk yet
+                if (m_journal.replay(*text_entries[0].text()))
+                {
+                    tree.append_unsaved_file(current_open_fp, m_window);
+                }
+                else
+                {
+                    m_journal.clear();
+                    tree.erase_unsaved_file(current_open_fp, m_window);
+                }
+            }
+        }
+
+        redraw = true;
+
+        SDL_SetWindowTitle(m_window,
+            (std::string("Grass | Editing ") + fs::path(fp).filename().string() + (tree.is_unsaved(fp) ? " - UNSAVED" : "")).c_str()
+        );
+    };
+
+    auto open_location = [&](const gui::SearchPanel::Location& location) {
+        tree.set_selected_highlight_rect({ 0, 0, 0, 0 });
+        open_path(location.path);
+
+        if (text_entries[0].hidden())
+            return;
+
+        gui::TextEntry& entry = text_entries[0];
+        gui::Text* text = entry.text();
+
+        // the match can be past what has been read or indexed so far
+        m_loader.finish(*text);
+
+        while (location.line >= text->line_count() && !text->index_lines(INDEX_BYTES_PER_FRAME))
+            ;
+
+        // the file could have changed since it was searched
+        int line = std::min(location.line, text->line_count() - 1);
+        int column = std::min(location.column, text->line_length(line));
+
+        // the match ends up in the middle of the screen instead of at the edge
+        SDL_Point span = { entry.max_bounds().x - entry.min_bounds().x, entry.max_bounds().y - entry.min_bounds().y };
+        entry.move_bounds_characters(column < span.x ? 0 : column - span.x / 2, std::max(0, line - span.y / 2));
+        entry.set_cursor_pos_characters(column, line);
+
+        m_selected_entry = &entry;
+    };
+
+    /* Typed text waits here until the end of the frame so a burst of it, from key repeat or an ime,
+    * goes into the entry as one edit instead of one per character.
+    */
+    std::string typed;
+    // backspaces that go past the typed text, they are erased before it is inserted
+    int erased = 0;
+
+    auto flush_typed = [&]() {
+        if (typed.empty() && erased == 0)
+            return;
+
+        if (m_selected_entry)
+        {
+            // edits are made to the whole file, not whatever part of it has been read so far
+            m_loader.finish(*text_entries[0].text());
+
+            if (erased > 0)
+                m_selected_entry->remove_chars(erased);
+
+            if (!typed.empty())
+            {
+                m_selected_entry->insert_text(typed);
+                m_selected_entry->stop_highlight();
+            }
+
+            tree.append_unsaved_file(current_open_fp, m_window);
+        }
+
+        typed.clear();
+        erased = 0;
+    };
+
+    // letters only ever type, enter and backspace are folded into the typed text, everything else needs it in the entry first
+    auto continues_typing = [&](const SDL_Event& evt) {
+        if (evt.type == SDL_TEXTINPUT || evt.type == SDL_KEYUP)
+            return true;
+
+        if (evt.type != SDL_KEYDOWN || ctrl_down)
+            return false;
+
+        SDL_Keycode key = evt.key.keysym.sym;
+        return (key >= SDLK_SPACE && key < SDLK_DELETE) || key == SDLK_RETURN || key == SDLK_BACKSPACE;
+    };
+
     while (running)
     {
+        if (m_before_frame)
+            m_before_frame();
+
+        {
+            // sleep until there is input, a timer runs out or a background task wakes the loop up
+            int timeout = -1;
+
+            auto wake_in = [&timeout](int ms) {
+                if (ms >= 0 && (timeout < 0 || ms < timeout))
+                    timeout = ms;
+            };
+
+            // dragging keeps scrolling even when the mouse doesnt move
+            if (mouse_down)
+                wake_in(DRAG_FRAME_TIME);
+
+            if (redraw || indexing)
+                wake_in(0);
+
+            if (m_selected_entry && !m_selected_entry->hidden())
+                wake_in(m_selected_entry->ms_until_blink());
+
+            wake_in(m_journal.ms_until_update());
+
+            if (status_shown)
+                wake_in(std::max(0, STATUS_DURATION - (int)(SDL_GetTicks() - status_time)));
+
+            if (timeout < 0)
+                SDL_WaitEvent(nullptr);
+            else
+                SDL_WaitEventTimeout(nullptr, timeout);
+        }
+
         int mx, my;
 
         {
@@ -128,14 +368,61 @@ void Grass::mainloop()
 
         while (SDL_PollEvent(&evt))
         {
+            if (!continues_typing(evt))
+                flush_typed();
+
             switch (evt.type)
             {
             case SDL_QUIT:
                 running = false;
                 break;
+            case SDL_WINDOWEVENT:
+                // exposed, resized, restored, the last frame might not be on screen anymore
+                redraw = true;
+                break;
 
             case SDL_MOUSEBUTTONDOWN:
             {
+                if (folder_picker.shown())
+                {
+                    folder_picker.mouse_down(mx, my, evt.button.clicks);
+                    break;
+                }
+
+                // clicking anywhere closes quick open, clicking a result opens it too
+                if (quick_open.shown())
+                {
+                    std::string path = quick_open.path_at(mx, my);
+                    quick_open.hide();
+
+                    if (!path.empty())
+                    {
+                        tree.set_selected_highlight_rect({ 0, 0, 0, 0 });
+                        open_path(path);
+                    }
+
+                    break;
+                }
+
+                // same for the search panel, except clicking inside it somewhere other than a result does nothing
+                if (search_panel.shown())
+                {
+                    gui::SearchPanel::Location location;
+
+                    if (search_panel.location_at(mx, my, location))
+                    {
+                        search_panel.hide();
+                        open_location(location);
+                    }
+                    else if (!search_panel.contains(mx, my))
+                    {
+                        search_panel.hide();
+                    }
+
+                    break;
+                }
+
+                // only set once no overlay took the click, otherwise dragging would move the cursor under it
                 mouse_down = true;
 
                 for (auto& btn : buttons)
@@ -165,7 +452,7 @@ void Grass::mainloop()
                     }
                 }
 
-                gui::File* file = tree.check_file_click(tree.folder(), mx, my);
+                gui::File* file = tree.check_file_click(mx, my);
 
                 if (file)
                 {
@@ -173,62 +460,17 @@ void Grass::mainloop()
                         tree.rect().x,
                         file->rect().y,
                         tree.rect().w,
-                        file->name().char_dim().y
+                        file->rect().h
                     });
 
-                    if (tree.is_unsaved(current_open_fp))
-                    {
-                        std::ofstream ofs(current_open_fp + "~", std::ofstream::out | std::ofstream::trunc);
-                        ofs << text_entries[0].text()->str();
-                        ofs.close();
-                    }
-
-                    text_entries[0].stop_highlight();
-
-                    current_open_fp = file->path();
-                    std::string ext = fs::path(current_open_fp).extension().string();
-
-                    if (ext == ".png" || ext == ".jpg" || ext == ".bmp" || ext == ".jpeg" || ext == ".webp")
-                    {
-                        editor_image = IMG_LoadTexture(m_rend, current_open_fp.c_str());
-
-                        if (!editor_image)
-                            editor_image = gui::common::render_text(m_rend, font_textbox.font(), SDL_GetError());
-
-                        text_entries[0].text()->set_contents({ "" });
-                        reset_entry_to_default(text_entries[0]);
-                        text_entries[0].hide();
-                        scrollbar.hide();
-                    }
-                    else
-                    {
-                        if (editor_image)
-                            SDL_DestroyTexture(editor_image);
-
-                        editor_image = nullptr;
-
-                        text_entries[0].show();
-                        scrollbar.show();
-                        
-                        if (fs::exists(current_open_fp + "~"))
-                            load_file(current_open_fp + "~", text_entries[0]);
-                        else
-                            load_file(current_open_fp, text_entries[0]);
-                    }
-
-                    tree.update_display();
-
-                    SDL_SetWindowTitle(m_window,
-                        (std::string("Grass | Editing ") + file->name().str().c_str() + (tree.is_unsaved(file->path()) ? " - UNSAVED" : "")).c_str()
-                    );
+                    open_path(file->path());
                 }
 
-                gui::Folder* folder = tree.check_folder_click(tree.folder(), mx, my);
+                gui::Folder* folder = tree.check_folder_click(mx, my);
 
                 if (folder)
                 {
-                    tree.collapse_folder(*folder, m_rend);
-                    tree.update_display();
+                    tree.collapse_folder(*folder);
 
                     tree.set_selected_highlight_rect({ 0, 0, 0, 0 });
                 }
@@ -255,13 +497,25 @@ void Grass::mainloop()
                 break;
 
             case SDL_TEXTINPUT:
-                if (m_selected_entry)
+                // the folder picker has nothing to type into
+                if (folder_picker.shown())
+                    break;
+
+                if (quick_open.shown())
                 {
-                    m_selected_entry->insert_char(evt.text.text[0]);
-                    m_selected_entry->stop_highlight();
-                    tree.append_unsaved_file(current_open_fp, m_window);
+                    quick_open.insert_text(evt.text.text);
+                    break;
+                }
+
+                if (search_panel.shown())
+                {
+                    search_panel.insert_text(evt.text.text);
+                    break;
                 }
 
+                if (m_selected_entry)
+                    typed += evt.text.text;
+
                 break;
             case SDL_KEYDOWN:
             {
@@ -273,23 +527,115 @@ void Grass::mainloop()
                     break;
                 }
 
-                switch (evt.key.keysym.sym)
+                // the folder picker takes every key while it is open
+                if (folder_picker.shown())
                 {
-                case SDLK_s:
-                    if (m_selected_entry)
+                    folder_picker.key_down(evt.key.keysym.sym);
+                    break;
+                }
+
+                if (ctrl_down && evt.key.keysym.sym == SDLK_p)
+                {
+                    if (quick_open.shown())
+                        quick_open.hide();
+                    else
+                        quick_open.show();
+
+                    search_panel.hide();
+                    break;
+                }
+
+                if (ctrl_down && (SDL_GetModState() & KMOD_SHIFT) && evt.key.keysym.sym == SDLK_f)
+                {
+                    if (search_panel.shown())
+                        search_panel.hide();
+                    else
+                        search_panel.show();
+
+                    quick_open.hide();
+                    break;
+                }
+
+                // quick open takes every key while it is open
+                if (quick_open.shown())
+                {
+                    switch (evt.key.keysym.sym)
                     {
-                        if (ctrl_down && m_selected_entry == &text_entries[0])
+                    case SDLK_ESCAPE:
+                        quick_open.hide();
+                        break;
+                    case SDLK_RETURN:
+                    {
+                        std::string path = quick_open.selected_path();
+                        quick_open.hide();
+
+                        if (!path.empty())
                         {
-                            std::ofstream ofs(current_open_fp, std::ofstream::out | std::ofstream::trunc);
+                            tree.set_selected_highlight_rect({ 0, 0, 0, 0 });
+                            open_path(path);
+                        }
+                    } break;
+                    case SDLK_BACKSPACE:
+                        quick_open.remove_char();
+                        break;
+                    case SDLK_UP:
+                        quick_open.move_selection(-1);
+                        break;
+                    case SDLK_DOWN:
+                        quick_open.move_selection(1);
+                        break;
+                    }
 
-                            for (auto& line : text_entries[0].text()->contents())
-                            {
-                                ofs << line << "\n";
-                            }
+                    break;
+                }
 
-                            ofs.close();
+                // the first enter searches for what was typed, the next one opens the selected match
+                if (search_panel.shown())
+                {
+                    switch (evt.key.keysym.sym)
+                    {
+                    case SDLK_ESCAPE:
+                        search_panel.hide();
+                        break;
+                    case SDLK_RETURN:
+                    {
+                        gui::SearchPanel::Location location;
 
-                            tree.erase_unsaved_file(current_open_fp, m_window);
+                        if (!search_panel.search() && search_panel.selected(location))
+                        {
+                            search_panel.hide();
+                            open_location(location);
+                        }
+                    } break;
+                    case SDLK_BACKSPACE:
+                        search_panel.remove_char();
+                        break;
+                    case SDLK_UP:
+                        search_panel.move_selection(-1);
+                        break;
+                    case SDLK_DOWN:
+                        search_panel.move_selection(1);
+                        break;
+                    }
+
+                    break;
+                }
+
+                switch (evt.key.keysym.sym)
+                {
+                case SDLK_s:
+                    if (m_selected_entry)
+                    {
+                        if (ctrl_down && m_selected_entry == &text_entries[0] && !text_entries[0].text()->read_only())
+                        {
+                            // saving half a file would lose the rest of it
+                            m_loader.finish(*text_entries[0].text());
+                            finish_save();
+
+                            // the snapshot doesnt change when typing continues, so it can be written on another thread
+                            saving_version = text_entries[0].text()->version();
+                            m_saver.start(current_open_fp, text_entries[0].text()->snapshot());
+                            m_journal.save_started(text_entries[0].text()->size());
                         }
                     }
 
@@ -299,6 +645,7 @@ void Grass::mainloop()
                     {
                         if (ctrl_down && m_selected_entry == &text_entries[0])
                         {
+                            m_journal.clear();
                             tree.erase_unsaved_file(current_open_fp, m_window);
                             load_file(current_open_fp, text_entries[0]);
                         }
@@ -308,44 +655,56 @@ void Grass::mainloop()
                 case SDLK_o:
                     if (ctrl_down)
                     {
-                        SDL_Rect rect = { 0, 0, wx, wy };
-                        SDL_SetRenderDrawColor(m_rend, 0, 0, 0, 255);
-                        SDL_RenderFillRect(m_rend, &rect);
-
-                        std::string waiting_text = "Waiting for open folder dialog to finish";
-                        SDL_Texture* text = gui::common::render_text(m_rend, font_textbox.font(), waiting_text.c_str());
-                        rect.x = wx / 2 - waiting_text.size() * font_textbox.char_dim().x / 2;
-                        rect.y = wy / 2 - font_textbox.char_dim().y / 2;
+                        quick_open.hide();
+                        search_panel.hide();
+                        folder_picker.show(".");
+                    }
 
-                        SDL_QueryTexture(text, nullptr, nullptr, &rect.w, &rect.h);
-                        SDL_RenderCopy(m_rend, text, nullptr, &rect);
+                    break;
+                case SDLK_c:
+                case SDLK_x:
+                    if (m_selected_entry && ctrl_down)
+                    {
+                        // only the highlighted range is copied out, never the whole file
+                        std::string text = m_selected_entry->highlighted_text();
 
-                        SDL_RenderPresent(m_rend);
+                        if (text.empty())
+                            break;
 
-                        // new window will take all input and releasing ctrl wont be detected in the main window
-                        ctrl_down = false;
+                        SDL_SetClipboardText(text.c_str());
 
-                        SDL_Point pos;
-                        SDL_GetWindowPosition(m_window, &pos.x, &pos.y);
-                        gui::Explorer e(".", gui::ExplorerMode::DIR, pos);
-                        std::string path = e.get_path();
-                        
-                        if (!path.empty())
+                        if (evt.key.keysym.sym == SDLK_x)
                         {
-                            tree.folder().change_directory(fs::absolute(path).string(), m_rend);
-                            tree.update_display();
-                            tree.set_selected_highlight_rect({ 0, 0, 0, 0 });
+                            m_loader.finish(*text_entries[0].text());
+                            m_selected_entry->remove_char();
+                            tree.append_unsaved_file(current_open_fp, m_window);
+                        }
+                    }
 
-                            text_entries[0].text()->set_contents({ "" });
-                            reset_entry_to_default(text_entries[0]);
-                            
-                            if (editor_image)
-                                SDL_DestroyTexture(editor_image);
+                    break;
+                case SDLK_v:
+                    if (m_selected_entry && ctrl_down && SDL_HasClipboardText())
+                    {
+                        char* clipboard = SDL_GetClipboardText();
+                        std::string text = clipboard;
+                        SDL_free(clipboard);
 
-                            editor_image = 0;
-                        }
+                        // windows hands out \r\n, the text only ever has \n
+                        text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+
+                        if (text.empty())
+                            break;
+
+                        m_loader.finish(*text_entries[0].text());
 
-                        SDL_DestroyTexture(text);
+                        // pasting over a highlight replaces it
+                        if (m_selected_entry->highlighting())
+                            m_selected_entry->remove_char();
+
+                        // one edit for the whole paste, however long it is
+                        m_selected_entry->insert_text(text);
+                        m_selected_entry->stop_highlight();
+                        tree.append_unsaved_file(current_open_fp, m_window);
                     }
 
                     break;
@@ -356,13 +715,22 @@ void Grass::mainloop()
                     switch (evt.key.keysym.scancode)
                     {
                     case SDL_SCANCODE_RETURN:
-                        m_selected_entry->insert_char('\n');
-                        tree.append_unsaved_file(current_open_fp, m_window);
-                        m_selected_entry->stop_highlight();
+                        typed += '\n';
                         break;
                     case SDL_SCANCODE_BACKSPACE:
-                        if (!mouse_down)
+                        // takes back typing that hasnt made it into the entry yet, a whole character even if an ime sent it
+                        if (!typed.empty())
+                        {
+                            gui::common::pop_utf8(typed);
+                        }
+                        else if (!mouse_down && !m_selected_entry->highlighting())
+                        {
+                            ++erased;
+                        }
+                        else if (!mouse_down)
                         {
+                            // a highlight is erased as a whole, the backspaces after it are batched again
+                            m_loader.finish(*text_entries[0].text());
                             m_selected_entry->remove_char();
                             tree.append_unsaved_file(current_open_fp, m_window);
                         }
@@ -407,21 +775,44 @@ void Grass::mainloop()
                 }
             } break;
             case SDL_MOUSEWHEEL:
-                if (gui::common::within_rect(tree.rect(), mx, my))
+                if (folder_picker.contains(mx, my))
+                {
+                    folder_picker.scroll(-evt.wheel.y * 3);
+                }
+                else if (search_panel.contains(mx, my))
+                {
+                    search_panel.scroll(-evt.wheel.y * 3);
+                }
+                else if (gui::common::within_rect(tree.rect(), mx, my))
                 {
                     tree.scroll(-evt.wheel.y, wy);
                 }
                 else if (gui::common::within_rect(text_entries[0].rect(), mx, my))
                 {
-                    text_entries[0].scroll(-evt.wheel.y);
+                    // shift turns a normal wheel sideways
+                    if (SDL_GetModState() & KMOD_SHIFT)
+                        text_entries[0].scroll_x(-evt.wheel.y * HORIZONTAL_SCROLL_SPEED);
+                    else if (evt.wheel.y != 0)
+                        text_entries[0].scroll(-evt.wheel.y);
+
+                    text_entries[0].scroll_x(evt.wheel.x * HORIZONTAL_SCROLL_SPEED);
                 }
                 break;
             }
         }
 
-        SDL_RenderClear(m_rend);
+        flush_typed();
 
-        if (mouse_down)
+        if (!m_file_to_open.empty())
+        {
+            open_path(m_file_to_open);
+            m_file_to_open.clear();
+        }
+
+        // an overlay opened in the middle of a drag, with ctrl+o or ctrl+p, takes the mouse from then on too
+        bool overlay_shown = folder_picker.shown() || quick_open.shown() || search_panel.shown();
+
+        if (mouse_down && !overlay_shown)
         {
             if (m_selected_entry)
             {
@@ -432,26 +823,47 @@ void Grass::mainloop()
         for (auto& btn : buttons)
         {
             btn.check_hover(mx, my);
-            btn.render(m_rend);
         }
 
-        tree.render(m_rend);
+        tree.update_hover(mx, my);
+        tree.update();
 
-        if (gui::common::within_rect(tree.rect(), mx, my))
-            tree.highlight_element(m_rend, mx, my);
+        quick_open.update();
+        search_panel.update();
+        folder_picker.update();
 
-        for (auto& e : text_entries)
+        std::string picked;
+
+        if (folder_picker.take_picked(picked))
         {
-            if (e.hidden())
-                continue;
+            std::string path = fs::absolute(picked).string();
 
-            bool render_mouse = false;
-            if (m_selected_entry == &e)
-                render_mouse = true;
+            tree.change_directory(path);
+            tree.set_selected_highlight_rect({ 0, 0, 0, 0 });
+            quick_open.set_root(path);
+            search_panel.set_root(path);
 
-            e.render(m_rend, render_mouse);
+            m_loader.cancel();
+            finish_save();
+            m_journal.close();
+            text_entries[0].text()->set_contents({ "" });
+            reset_entry_to_default(text_entries[0]);
+
+            if (editor_image)
+                SDL_DestroyTexture(editor_image);
+
+            editor_image = 0;
+            redraw = true;
         }
 
+        indexing = !text_entries[0].text()->index_lines(INDEX_BYTES_PER_FRAME);
+
+        // once the last of it is in progress is 1, so the final status says it is all there
+        if (m_loader.loading())
+        {
+            m_loader.poll(*text_entries[0].text());
+            set_status("Loading " + fs::path(m_loader.path()).filename().string() + " " + std::to_string((int)(m_loader.progress() * 100)) + "%");
+        }
 
         if (!scrollbar.hidden())
         {
@@ -460,7 +872,7 @@ void Grass::mainloop()
 
             if (!scrollbar.down())
             {
-                scrollbar.set_bounds(min_bound.y, max_bound.y, text_entries[0].text()->contents().size() + (max_bound.y - min_bound.y));
+                scrollbar.set_bounds(min_bound.y, max_bound.y, text_entries[0].text()->line_count() + (max_bound.y - min_bound.y));
             }
             else
             {
@@ -468,8 +880,6 @@ void Grass::mainloop()
 
                 text_entries[0].move_bounds_characters(0, scrollbar.min_position() - min_bound.y);
             }
-
-            scrollbar.render(m_rend);
         }
 
         if (prev_wx != wx || prev_wy != wy)
@@ -485,6 +895,63 @@ void Grass::mainloop()
             prev_wy = wy;
         }
 
+        m_journal.update();
+
+        if (m_saver.saving())
+            set_status("Saving " + fs::path(m_saver.path()).filename().string() + " " + std::to_string((int)(m_saver.progress() * 100)) + "%");
+
+        if (m_saver.poll())
+            save_finished();
+
+        bool show_status = status_tex && SDL_GetTicks() - status_time < STATUS_DURATION;
+
+        if (show_status != status_shown)
+            redraw = true;
+
+        /* Render only if something looks different, otherwise the last frame is still correct */
+
+        bool dirty = redraw || tree.dirty() || scrollbar.dirty() || quick_open.dirty() || search_panel.dirty() || folder_picker.dirty();
+
+        for (auto& btn : buttons)
+            dirty |= btn.dirty();
+
+        for (auto& e : text_entries)
+            dirty |= e.dirty(m_selected_entry == &e);
+
+        if (!dirty)
+        {
+            if (m_after_frame)
+                m_after_frame(false);
+
+            continue;
+        }
+
+        redraw = false;
+        status_shown = show_status;
+
+        SDL_RenderClear(m_rend);
+
+        for (auto& btn : buttons)
+        {
+            btn.render(m_rend);
+        }
+
+        tree.render(m_rend);
+
+        if (gui::common::within_rect(tree.rect(), mx, my))
+            tree.highlight_element(m_rend, mx, my);
+
+        for (auto& e : text_entries)
+        {
+            bool render_mouse = false;
+            if (m_selected_entry == &e)
+                render_mouse = true;
+
+            e.render(m_rend, render_mouse);
+        }
+
+        scrollbar.render(m_rend);
+
         if (editor_image)
         {
             int img_w, img_h;
@@ -503,30 +970,87 @@ void Grass::mainloop()
             SDL_RenderCopy(m_rend, editor_image, nullptr, &dstrect);
         }
 
+        search_panel.render(m_rend, wx, wy);
+        quick_open.render(m_rend, wx);
+        folder_picker.render(m_rend, wx, wy);
+
+        if (show_status)
+        {
+            SDL_Rect rect;
+            SDL_QueryTexture(status_tex.get(), nullptr, nullptr, &rect.w, &rect.h);
+
+            rect.x = wx - rect.w - 10;
+            rect.y = (main_text_dimensions.y - rect.h) / 2;
+
+            SDL_RenderCopy(m_rend, status_tex.get(), nullptr, &rect);
+        }
+
         SDL_SetRenderDrawColor(m_rend, BG_COLOR, 255);
         SDL_RenderPresent(m_rend);
+
+        if (m_after_frame)
+            m_after_frame(true);
     }
     
+    // the journal is the only thing that deletes its logs
     for (auto& path : tree.unsaved())
     {
-        if (fs::exists(path + "~"))
-            fs::remove(path + "~");
+        m_journal.open(path);
+        m_journal.clear();
     }
+
+    m_journal.close();
 }
 
 
 void Grass::load_file(const std::string& fp, gui::TextEntry& entry)
 {
-    std::ifstream ifs(fp);
+    m_loader.cancel();
+
+    // the file might still be getting replaced by a save
+    if (m_saver.path() == fp)
+        m_saver.finish();
+
+    std::error_code ec;
+    size_t size = fs::file_size(fp, ec);
+
+    if (ec)
+        size = 0;
 
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(ifs, line)) lines.emplace_back(line);
+    if (size >= MAPPED_FILE_THRESHOLD)
+    {
+        auto mapped = std::make_shared<gui::MappedText>(fp);
+
+        if (mapped->is_open())
+        {
+            // only the first screen of lines is needed to show the file, the rest gets indexed a bit every frame
+            mapped->index_to_line(entry.rect().h / entry.text()->char_dim().y + 1);
 
-    ifs.close();
+            entry.text()->set_mapped(mapped);
+            reset_entry_to_default(entry);
+            return;
+        }
+    }
 
-    entry.text()->set_contents(lines);
+    // the file is read on another thread and shows up as it arrives, starting with the first screen
+    entry.text()->set_str("");
     reset_entry_to_default(entry);
+
+    m_loader.start(fp);
+}
+
+
+void Grass::open_file(const std::string& fp)
+{
+    m_file_to_open = fp;
+    gui::common::wake_main_loop();
+}
+
+
+void Grass::set_frame_hooks(std::function<void()> before_frame, std::function<void(bool presented)> after_frame)
+{
+    m_before_frame = std::move(before_frame);
+    m_after_frame = std::move(after_frame);
 }
 
 
@@ -535,6 +1059,5 @@ void Grass::reset_entry_to_default(gui::TextEntry& entry)
     entry.reset_bounds_x();
     entry.reset_bounds_y();
     entry.set_cursor_pos_characters(0, 0);
-    entry.update_cache();
     entry.show();
 }
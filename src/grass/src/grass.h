@@ -1,5 +1,9 @@
 #pragma once
 #include "text_entry.h"
+#include "file_loader.h"
+#include "file_saver.h"
+#include "journal.h"
+#include <functional>
 
 
 class Grass
@@ -14,9 +18,31 @@ public:
     void load_file(const std::string& fp, gui::TextEntry& entry);
     void reset_entry_to_default(gui::TextEntry& entry);
 
+    // opens fp as if it had been clicked in the tree, on the next iteration of the main loop
+    void open_file(const std::string& fp);
+
+    /* Lets grass_bench drive the main loop. before_frame runs at the start of every iteration
+    * before waiting for events, after_frame at the end of it with whether a frame was presented.
+    */
+    void set_frame_hooks(std::function<void()> before_frame, std::function<void(bool presented)> after_frame);
+
+    SDL_Window* window() { return m_window; }
+
 private:
     SDL_Window* m_window;
     SDL_Renderer* m_rend;
 
     gui::TextEntry* m_selected_entry{ nullptr };
+
+    // fills text_entries[0] while a file is being opened
+    gui::FileLoader m_loader;
+    gui::FileSaver m_saver;
+    // unsaved edits of the open file
+    gui::Journal m_journal;
+
+    // set by open_file
+    std::string m_file_to_open;
+
+    std::function<void()> m_before_frame;
+    std::function<void(bool presented)> m_after_frame;
 };
\ No newline at end of file
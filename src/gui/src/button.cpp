@@ -21,6 +21,8 @@ gui::Button::~Button()
 
 void gui::Button::render(SDL_Renderer* rend)
 {
+    m_dirty = false;
+
     SDL_Color col = m_color;
 
     if (m_down)
@@ -52,6 +54,7 @@ bool gui::Button::check_clicked(int mx, int my)
     if (common::within_rect(m_rect, mx, my))
     {
         m_down = true;
+        m_dirty = true;
         m_function();
         return true;
     }
@@ -62,5 +65,8 @@ bool gui::Button::check_clicked(int mx, int my)
 
 void gui::Button::check_hover(int mx, int my)
 {
-    m_hover = common::within_rect(m_rect, mx, my);
+    bool hover = common::within_rect(m_rect, mx, my);
+
+    m_dirty |= hover != m_hover;
+    m_hover = hover;
 }
\ No newline at end of file
@@ -27,7 +27,9 @@ namespace gui
         */
         void check_hover(int mx, int my);
 
-        void set_down(bool b) { m_down = b; }
+        void set_down(bool b) { m_dirty |= m_down != b; m_down = b; }
+        // true if something changed since the last render
+        bool dirty() { return m_dirty; }
 
     private:
         Text m_text;
@@ -39,5 +41,6 @@ namespace gui
         std::function<void(void)> m_function;
         bool m_down{ false };
         bool m_hover{ false };
+        bool m_dirty{ true };
     };
 }
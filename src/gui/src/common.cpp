@@ -44,6 +44,26 @@ bool gui::common::within_rect(SDL_Rect rect, int x, int y)
 }
 
 
+void gui::common::pop_utf8(std::string& text)
+{
+    // continuation bytes are 10xxxxxx, the lead byte goes with them
+    while (!text.empty() && ((unsigned char)text.back() & 0xC0) == 0x80)
+        text.pop_back();
+
+    if (!text.empty())
+        text.pop_back();
+}
+
+
+void gui::common::wake_main_loop()
+{
+    SDL_Event evt{};
+    evt.type = SDL_USEREVENT;
+
+    SDL_PushEvent(&evt);
+}
+
+
 gui::common::Font::Font(const std::string& ttf_path, int pt_size)
 {
     m_font = TTF_OpenFont(ttf_path.c_str(), pt_size);
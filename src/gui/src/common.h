@@ -39,4 +39,10 @@ namespace gui::common
     void center_rendered_text(SDL_Renderer* rend, SDL_Texture* tex, const char* text, SDL_Rect enclosing_rect, SDL_Point char_dim, SDL_Color color);
 
     bool within_rect(SDL_Rect rect, int x, int y);
+
+    // removes the last character of text, every byte of it if it is a multibyte utf-8 character
+    void pop_utf8(std::string& text);
+
+    // pushes an empty event so a main loop waiting for events wakes up, safe to call from any thread
+    void wake_main_loop();
 }
\ No newline at end of file
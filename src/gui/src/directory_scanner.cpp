@@ -0,0 +1,207 @@
+#include "directory_scanner.h"
+#include "common.h"
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+
+// entries are handed over once this many are found, or after BATCH_TIME
+#define BATCH_SIZE 512
+// in ms
+#define BATCH_TIME 16
+#define MAX_THREADS 4
+
+namespace fs = std::filesystem;
+
+
+gui::DirectoryScanner::DirectoryScanner(int threads)
+{
+    if (threads <= 0)
+        threads = std::clamp((int)std::thread::hardware_concurrency(), 2, MAX_THREADS);
+
+    for (int i = 0; i < threads; ++i)
+        m_threads.emplace_back(&DirectoryScanner::work, this);
+}
+
+
+gui::DirectoryScanner::~DirectoryScanner()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_quit = true;
+        m_queue.clear();
+    }
+
+    m_wake.notify_all();
+
+    for (auto& t : m_threads)
+        t.join();
+}
+
+
+size_t gui::DirectoryScanner::scan(const std::string& path, fs::file_time_type known)
+{
+    size_t id;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        id = m_next_id++;
+        m_queue.push_back({ id, path, known });
+    }
+
+    m_wake.notify_one();
+
+    return id;
+}
+
+
+void gui::DirectoryScanner::cancel(size_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto queued = std::find_if(m_queue.begin(), m_queue.end(), [id](const Job& job) { return job.id == id; });
+
+    // not started yet, so it can just be forgotten, otherwise the thread listing it stops at the next batch
+    if (queued != m_queue.end())
+        m_queue.erase(queued);
+    else if (m_running.count(id))
+        m_cancelled.insert(id);
+
+    m_results.erase(std::remove_if(m_results.begin(), m_results.end(), [id](const Batch& b) { return b.id == id; }), m_results.end());
+}
+
+
+std::vector<gui::DirectoryScanner::Batch> gui::DirectoryScanner::take()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<Batch> results;
+    results.swap(m_results);
+
+    return results;
+}
+
+
+bool gui::DirectoryScanner::hidden(const std::string& name)
+{
+    // backups and journals end in ~
+    fs::path p(name);
+    std::string ext = p.extension().string();
+
+    return p.has_extension() && ext[ext.size() - 1] == '~';
+}
+
+
+void gui::DirectoryScanner::work()
+{
+    while (true)
+    {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_quit || !m_queue.empty(); });
+
+            if (m_quit)
+                return;
+
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+
+            m_running.insert(job.id);
+        }
+
+        std::error_code ec;
+        // taken first, anything changed while listing makes the next scan list it again
+        fs::file_time_type mtime = fs::last_write_time(job.path, ec);
+
+        if (ec)
+            mtime = fs::file_time_type::min();
+
+        Batch batch{ job.id, {}, false, mtime, false };
+
+        if (mtime != fs::file_time_type::min() && mtime == job.known)
+        {
+            batch.done = true;
+            batch.unchanged = true;
+            publish(batch);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running.erase(job.id);
+            m_cancelled.erase(job.id);
+            continue;
+        }
+
+        auto last_publish = std::chrono::steady_clock::now();
+        bool cancelled = false;
+
+        fs::directory_iterator it(job.path, fs::directory_options::skip_permission_denied, ec);
+
+        for (; !ec && it != fs::directory_iterator(); it.increment(ec))
+        {
+            std::string name = it->path().filename().string();
+
+            if (hidden(name))
+                continue;
+
+            std::error_code dir_ec;
+            batch.entries.push_back({ std::move(name), it->is_directory(dir_ec) });
+
+            // the first few show up right away, after that they come in bigger batches
+            if (batch.entries.size() >= BATCH_SIZE || std::chrono::steady_clock::now() - last_publish > std::chrono::milliseconds(BATCH_TIME))
+            {
+                if (!publish(batch))
+                {
+                    cancelled = true;
+                    break;
+                }
+
+                last_publish = std::chrono::steady_clock::now();
+            }
+        }
+
+        if (!cancelled)
+        {
+            batch.done = true;
+            publish(batch);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running.erase(job.id);
+        m_cancelled.erase(job.id);
+    }
+}
+
+
+bool gui::DirectoryScanner::publish(Batch& batch)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t id = batch.id;
+
+        if (m_quit || m_cancelled.count(id))
+            return false;
+
+        // the main loop hasnt taken the last batch yet, so this one goes on the end of it
+        auto taken = std::find_if(m_results.begin(), m_results.end(), [id](const Batch& b) { return b.id == id; });
+
+        if (taken == m_results.end())
+        {
+            m_results.push_back(std::move(batch));
+        }
+        else
+        {
+            taken->entries.insert(taken->entries.end(), std::make_move_iterator(batch.entries.begin()), std::make_move_iterator(batch.entries.end()));
+            taken->done = batch.done;
+            taken->unchanged = batch.unchanged;
+        }
+
+        batch.entries.clear();
+    }
+
+    common::wake_main_loop();
+
+    return true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <filesystem>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+namespace gui
+{
+    /* Lists directories on a pool of background threads, so a slow disk or network mount never blocks
+    * the main loop and several folders can be listed at once.
+    * What has been found so far is handed out in batches by take, while the rest is still being listed.
+    */
+    class DirectoryScanner
+    {
+    public:
+        struct Entry
+        {
+            std::string name;
+            bool directory;
+        };
+
+        struct Batch
+        {
+            size_t id;
+            std::vector<Entry> entries;
+            // nothing else will come for this id
+            bool done;
+
+            // when the directory was last changed, taken before it was listed
+            std::filesystem::file_time_type mtime;
+            // the directory still had the mtime it was scanned with, so it wasnt listed again
+            bool unchanged;
+        };
+
+        // threads is the most directories listed at the same time, 0 picks something based on the cpu
+        explicit DirectoryScanner(int threads = 0);
+        ~DirectoryScanner();
+
+        DirectoryScanner(const DirectoryScanner&) = delete;
+        DirectoryScanner& operator=(const DirectoryScanner&) = delete;
+
+        /* Queues path to be listed, the returned id is never 0.
+        * If the directory was last changed at known it isnt listed at all, a single unchanged batch is returned instead.
+        */
+        size_t scan(const std::string& path, std::filesystem::file_time_type known = std::filesystem::file_time_type::min());
+        // nothing more is returned for id, even if it was already found
+        void cancel(size_t id);
+
+        // everything found since the last call, at most one batch per id
+        std::vector<Batch> take();
+
+        // files grass makes next to the ones being edited arent shown
+        static bool hidden(const std::string& name);
+
+    private:
+        struct Job
+        {
+            size_t id;
+            std::string path;
+            std::filesystem::file_time_type known;
+        };
+
+        void work();
+        // moves the entries of batch into the results, returns false if the scan was cancelled
+        bool publish(Batch& batch);
+
+    private:
+        std::vector<std::thread> m_threads;
+
+        // everything below is guarded by m_mutex
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+
+        std::deque<Job> m_queue;
+        // being listed right now, and the ones of those that were cancelled
+        std::unordered_set<size_t> m_running;
+        std::unordered_set<size_t> m_cancelled;
+        std::vector<Batch> m_results;
+
+        size_t m_next_id{ 1 };
+        bool m_quit{ false };
+    };
+}
@@ -0,0 +1,222 @@
+#include "directory_watcher.h"
+#include "directory_scanner.h"
+#include "common.h"
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <tuple>
+#include <cstdint>
+
+#if defined(__linux__)
+#  include <sys/inotify.h>
+#  include <sys/eventfd.h>
+#  include <poll.h>
+#  include <unistd.h>
+#  include <cerrno>
+#endif /* if defined(__linux__) */
+
+// changes are handed out once nothing happened for this long, in ms
+#define QUIET_TIME 30
+// or once the first of them is this old, so a build that never stops writing still shows up
+#define MAX_DELAY 250
+
+
+gui::DirectoryWatcher::DirectoryWatcher()
+{
+#if defined(__linux__)
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_quit_fd = eventfd(0, EFD_CLOEXEC);
+
+    if (m_fd != -1 && m_quit_fd != -1)
+        m_thread = std::thread(&DirectoryWatcher::work, this);
+#endif /* if defined(__linux__) */
+}
+
+
+gui::DirectoryWatcher::~DirectoryWatcher()
+{
+#if defined(__linux__)
+    if (m_thread.joinable())
+    {
+        uint64_t one = 1;
+
+        // an eventfd write only fails if the counter would overflow, it is only ever written to here
+        // so the result isnt needed, the thread wakes up either way
+        (void)!write(m_quit_fd, &one, sizeof(one));
+        m_thread.join();
+    }
+
+    if (m_fd != -1)
+        close(m_fd);
+
+    if (m_quit_fd != -1)
+        close(m_quit_fd);
+#endif /* if defined(__linux__) */
+}
+
+
+int gui::DirectoryWatcher::watch(const std::string& path)
+{
+#if defined(__linux__)
+    if (!m_thread.joinable())
+        return 0;
+
+    // the entries of deleted files are gone from the directory right away, even if something still has them open
+    int wd = inotify_add_watch(m_fd, path.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_EXCL_UNLINK);
+
+    if (wd == -1)
+        return 0;
+
+    ++m_users[wd];
+    return wd;
+#else
+    return 0;
+#endif /* if defined(__linux__) */
+}
+
+
+void gui::DirectoryWatcher::unwatch(int watch)
+{
+    if (watch == 0)
+        return;
+
+    auto it = m_users.find(watch);
+
+    // someone else is still watching the same directory
+    if (it != m_users.end() && --it->second > 0)
+        return;
+
+    if (it != m_users.end())
+        m_users.erase(it);
+
+#if defined(__linux__)
+    // fails if the directory was deleted, the watch is already gone then
+    inotify_rm_watch(m_fd, watch);
+#endif /* if defined(__linux__) */
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto& changes = m_results.changes;
+    changes.erase(std::remove_if(changes.begin(), changes.end(), [watch](const Change& c) { return c.watch == watch; }), changes.end());
+}
+
+
+gui::DirectoryWatcher::Changes gui::DirectoryWatcher::take()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Changes results;
+    std::swap(results, m_results);
+
+    return results;
+}
+
+
+void gui::DirectoryWatcher::work()
+{
+#if defined(__linux__)
+    using clock = std::chrono::steady_clock;
+
+    std::vector<Change> pending;
+    bool overflowed = false;
+
+    clock::time_point first, last;
+
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    while (true)
+    {
+        int timeout = -1;
+
+        if (!pending.empty() || overflowed)
+        {
+            clock::time_point until = std::min(last + std::chrono::milliseconds(QUIET_TIME), first + std::chrono::milliseconds(MAX_DELAY));
+            clock::time_point now = clock::now();
+
+            if (now >= until)
+            {
+                publish(pending, overflowed);
+                overflowed = false;
+                continue;
+            }
+
+            timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(until - now).count() + 1;
+        }
+
+        pollfd fds[2] = {
+            { m_fd, POLLIN, 0 },
+            { m_quit_fd, POLLIN, 0 }
+        };
+
+        if (poll(fds, 2, timeout) == -1 && errno != EINTR)
+            return;
+
+        if (fds[1].revents & POLLIN)
+            return;
+
+        if (!(fds[0].revents & POLLIN))
+            continue;
+
+        if (pending.empty() && !overflowed)
+            first = clock::now();
+
+        last = clock::now();
+
+        // the fd doesnt block, so this reads until there is nothing left
+        ssize_t length;
+
+        while ((length = read(m_fd, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* p = buffer; p < buffer + length;)
+            {
+                inotify_event* event = (inotify_event*)p;
+                p += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    overflowed = true;
+                    continue;
+                }
+
+                // events without a name are about the directory itself
+                if (event->len == 0)
+                    continue;
+
+                std::string name = event->name;
+
+                if (DirectoryScanner::hidden(name))
+                    continue;
+
+                bool exists = (event->mask & (IN_CREATE | IN_MOVED_TO)) != 0;
+                pending.push_back({ event->wd, std::move(name), (event->mask & IN_ISDIR) != 0, exists });
+            }
+        }
+    }
+#endif /* if defined(__linux__) */
+}
+
+
+void gui::DirectoryWatcher::publish(std::vector<Change>& pending, bool overflowed)
+{
+    // only the last change to an entry matters, creating and then deleting a file is the same as deleting it
+    std::set<std::tuple<int, std::string, bool>> seen;
+    std::vector<Change> changes;
+
+    for (auto it = pending.rbegin(); it != pending.rend(); ++it)
+    {
+        if (seen.insert({ it->watch, it->name, it->directory }).second)
+            changes.emplace_back(std::move(*it));
+    }
+
+    std::reverse(changes.begin(), changes.end());
+    pending.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_results.changes.insert(m_results.changes.end(), std::make_move_iterator(changes.begin()), std::make_move_iterator(changes.end()));
+        m_results.overflowed |= overflowed;
+    }
+
+    common::wake_main_loop();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <unordered_map>
+
+
+namespace gui
+{
+    /* Watches directories for entries being created, deleted or renamed, using inotify on linux.
+    * Events are collected on a background thread and handed out once nothing has happened for a moment,
+    * so something like a git checkout ends up as a few big batches instead of thousands of small ones.
+    * Everywhere else watch always fails and nothing is ever returned.
+    */
+    class DirectoryWatcher
+    {
+    public:
+        struct Change
+        {
+            // the directory it happened in, as returned by watch
+            int watch;
+            std::string name;
+            bool directory;
+            // false if it was deleted or moved away
+            bool exists;
+        };
+
+        struct Changes
+        {
+            std::vector<Change> changes;
+            // too much happened at once and some of it was lost, everything being watched could have changed
+            bool overflowed{ false };
+        };
+
+        DirectoryWatcher();
+        ~DirectoryWatcher();
+
+        DirectoryWatcher(const DirectoryWatcher&) = delete;
+        DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+        /* Starts watching the entries directly inside of path, returns 0 if it cant be watched.
+        * Watching the same directory twice, through a symlink for example, returns the same watch,
+        * which keeps going until unwatch has been called as many times as watch.
+        */
+        int watch(const std::string& path);
+        void unwatch(int watch);
+
+        // everything that changed since the last call, in the order it happened
+        Changes take();
+
+    private:
+        void work();
+        // moves the changes collected on the thread into the results, dropping the ones that were undone later on
+        void publish(std::vector<Change>& pending, bool overflowed);
+
+    private:
+        int m_fd{ -1 };
+        // written to when the thread should quit
+        int m_quit_fd{ -1 };
+
+        std::thread m_thread;
+
+        // how many times every watch was handed out, inotify gives out the same one for the same directory
+        // only touched by the thread calling watch and unwatch
+        std::unordered_map<int, int> m_users;
+
+        // guards m_results
+        std::mutex m_mutex;
+        Changes m_results;
+    };
+}
@@ -0,0 +1,149 @@
+#include "file_loader.h"
+#include "common.h"
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+
+// small first read so the first screen shows up right away
+#define FIRST_CHUNK_SIZE (64 * 1024)
+#define CHUNK_SIZE (1024 * 1024)
+
+namespace fs = std::filesystem;
+
+
+gui::FileLoader::~FileLoader()
+{
+    cancel();
+}
+
+
+void gui::FileLoader::start(const std::string& fp)
+{
+    cancel();
+
+    std::error_code ec;
+    size_t size = fs::file_size(fp, ec);
+
+    m_path = fp;
+    m_pending.clear();
+    m_done = false;
+    m_cancel = false;
+    m_bytes_read = 0;
+    m_bytes_total = ec ? 0 : size;
+
+    m_loading = true;
+    m_held_new_line = false;
+
+    m_thread = std::thread(&FileLoader::read, this, fp);
+}
+
+
+void gui::FileLoader::cancel()
+{
+    m_cancel = true;
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    m_loading = false;
+}
+
+
+bool gui::FileLoader::poll(Text& text)
+{
+    if (!m_loading)
+        return false;
+
+    std::string chunk;
+    bool done;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        chunk.swap(m_pending);
+        done = m_done;
+    }
+
+    if (done)
+    {
+        if (m_thread.joinable())
+            m_thread.join();
+
+        m_loading = false;
+    }
+
+    if (chunk.empty())
+        return false;
+
+    if (m_held_new_line)
+    {
+        text.append("\n");
+        m_held_new_line = false;
+    }
+
+    std::string_view view = chunk;
+
+    if (view.back() == '\n')
+    {
+        view.remove_suffix(1);
+        m_held_new_line = true;
+    }
+
+    text.append(view);
+    return true;
+}
+
+
+void gui::FileLoader::finish(Text& text)
+{
+    if (!m_loading)
+        return;
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    poll(text);
+}
+
+
+float gui::FileLoader::progress() const
+{
+    if (!m_loading || m_bytes_total == 0)
+        return 1.0f;
+
+    return std::min(1.0f, (float)m_bytes_read / (float)m_bytes_total);
+}
+
+
+void gui::FileLoader::read(const std::string& fp)
+{
+    std::ifstream ifs(fp);
+    std::string buffer;
+    size_t chunk_size = FIRST_CHUNK_SIZE;
+
+    while (ifs && !m_cancel)
+    {
+        buffer.resize(chunk_size);
+        ifs.read(buffer.data(), buffer.size());
+        buffer.resize(ifs.gcount());
+
+        if (buffer.empty())
+            break;
+
+        m_bytes_read += buffer.size();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending += buffer;
+        }
+
+        common::wake_main_loop();
+        chunk_size = CHUNK_SIZE;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done = true;
+    }
+
+    common::wake_main_loop();
+}
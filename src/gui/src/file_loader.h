@@ -0,0 +1,61 @@
+#pragma once
+#include "text.h"
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+
+namespace gui
+{
+    /* Reads a file on a background thread. Whatever has been read so far gets appended to a Text
+    * every time poll is called, so the start of the file can be shown while the rest is still loading.
+    */
+    class FileLoader
+    {
+    public:
+        FileLoader() = default;
+        ~FileLoader();
+
+        FileLoader(const FileLoader&) = delete;
+        FileLoader& operator=(const FileLoader&) = delete;
+
+        // cancels whatever is currently loading and starts reading fp
+        void start(const std::string& fp);
+        void cancel();
+
+        /* Appends everything read since the last call to the end of text.
+        * Returns true if text was changed.
+        */
+        bool poll(Text& text);
+
+        // blocks until the whole file has been read into text
+        void finish(Text& text);
+
+        bool loading() const { return m_loading; }
+        // between 0 and 1, 1 once it is done
+        float progress() const;
+        // the file being loaded, or that was loaded last
+        const std::string& path() const { return m_path; }
+
+    private:
+        void read(const std::string& fp);
+
+    private:
+        std::thread m_thread;
+        std::string m_path;
+
+        std::mutex m_mutex;
+        // read but not given to the text yet, guarded by m_mutex
+        std::string m_pending;
+        bool m_done{ false };
+
+        std::atomic<bool> m_cancel{ false };
+        std::atomic<size_t> m_bytes_read{ 0 };
+        std::atomic<size_t> m_bytes_total{ 0 };
+
+        bool m_loading{ false };
+        // a trailing new line doesnt start another line, so the last one is only appended once more text follows it
+        bool m_held_new_line{ false };
+    };
+}
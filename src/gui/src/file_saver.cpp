@@ -0,0 +1,198 @@
+#include "file_saver.h"
+#include "common.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <sys/stat.h>
+#  include <sys/uio.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <climits>
+#endif /* if defined(_WIN32) */
+
+namespace fs = std::filesystem;
+
+
+gui::FileSaver::~FileSaver()
+{
+    // quitting in the middle of a save should still save
+    finish();
+}
+
+
+void gui::FileSaver::start(const std::string& fp, PieceTable contents)
+{
+    finish();
+
+    m_path = fp;
+    m_contents = std::move(contents);
+    m_error.clear();
+
+    m_done = false;
+    m_bytes_written = 0;
+    m_bytes_total = m_contents.size() + 1;
+
+    m_saving = true;
+    m_thread = std::thread(&FileSaver::write, this);
+}
+
+
+void gui::FileSaver::finish()
+{
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+
+bool gui::FileSaver::poll()
+{
+    if (!m_saving || !m_done)
+        return false;
+
+    finish();
+
+    // the snapshot keeps old pieces and add buffers alive, no need for them anymore
+    m_contents = PieceTable();
+    m_saving = false;
+
+    return true;
+}
+
+
+float gui::FileSaver::progress() const
+{
+    if (!m_saving || m_bytes_total == 0)
+        return 1.0f;
+
+    return std::min(1.0f, (float)m_bytes_written / (float)m_bytes_total);
+}
+
+
+void gui::FileSaver::write()
+{
+    // a symlink is saved through, renaming over it would replace the link with a plain file
+    std::error_code ec;
+    std::string target = fs::canonical(m_path, ec).string();
+
+    // new files dont exist yet to be resolved
+    if (ec)
+        target = m_path;
+
+    std::string tmp_path = target + ".save~";
+
+    std::vector<std::string_view> pieces = m_contents.pieces();
+    pieces.emplace_back("\n");
+
+#if defined(_WIN32)
+    // text mode so new lines are written the way the rest of windows expects them
+    std::ofstream ofs(tmp_path, std::ofstream::out | std::ofstream::trunc);
+
+    for (auto piece : pieces)
+    {
+        ofs.write(piece.data(), piece.size());
+        m_bytes_written += piece.size();
+    }
+
+    ofs.close();
+
+    if (!ofs)
+        m_error = "could not write " + tmp_path;
+    else if (!MoveFileExA(tmp_path.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        m_error = "could not replace " + target;
+#else
+    // keep the permissions of the file being replaced
+    struct stat st;
+    mode_t mode = stat(target.c_str(), &st) == 0 ? (st.st_mode & 07777) : 0644;
+
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode);
+
+    if (fd == -1)
+    {
+        m_error = std::strerror(errno);
+        m_done = true;
+        common::wake_main_loop();
+        return;
+    }
+
+    fchmod(fd, mode);
+
+    // the pieces already point at the text, so they are handed to the kernel as they are instead of being joined first
+    std::vector<iovec> iov(pieces.size());
+
+    for (size_t i = 0; i < pieces.size(); ++i)
+    {
+        iov[i].iov_base = (void*)pieces[i].data();
+        iov[i].iov_len = pieces[i].size();
+    }
+
+    size_t first = 0;
+
+    while (first < iov.size())
+    {
+        int count = (int)std::min(iov.size() - first, (size_t)IOV_MAX);
+        ssize_t written = writev(fd, iov.data() + first, count);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            m_error = std::strerror(errno);
+            break;
+        }
+
+        m_bytes_written += written;
+        common::wake_main_loop();
+
+        // skip whatever was written completely and move the start of a partly written one
+        while (first < iov.size() && (size_t)written >= iov[first].iov_len)
+        {
+            written -= iov[first].iov_len;
+            ++first;
+        }
+
+        if (first < iov.size())
+        {
+            iov[first].iov_base = (char*)iov[first].iov_base + written;
+            iov[first].iov_len -= written;
+        }
+    }
+
+    if (m_error.empty() && fsync(fd) == -1)
+        m_error = std::strerror(errno);
+
+    if (close(fd) == -1 && m_error.empty())
+        m_error = std::strerror(errno);
+
+    if (m_error.empty() && rename(tmp_path.c_str(), target.c_str()) == -1)
+        m_error = std::strerror(errno);
+
+    if (m_error.empty())
+    {
+        // the rename itself is only durable once the directory is flushed
+        std::string dir = fs::path(target).parent_path().string();
+        int dir_fd = open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (dir_fd != -1)
+        {
+            fsync(dir_fd);
+            close(dir_fd);
+        }
+    }
+#endif /* if defined(_WIN32) */
+
+    if (!m_error.empty())
+    {
+        fs::remove(tmp_path, ec);
+    }
+
+    m_done = true;
+    common::wake_main_loop();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "piece_table.h"
+#include <string>
+#include <thread>
+#include <atomic>
+
+
+namespace gui
+{
+    /* Writes a snapshot of a document on a background thread. The file is written to a temporary file
+    * next to it, flushed to disk and then renamed over the original, so a crash mid save never leaves
+    * a half written file behind. Symlinks are followed, the file they point at is the one replaced.
+    */
+    class FileSaver
+    {
+    public:
+        FileSaver() = default;
+        ~FileSaver();
+
+        FileSaver(const FileSaver&) = delete;
+        FileSaver& operator=(const FileSaver&) = delete;
+
+        // waits for the previous save and starts writing contents followed by a new line to fp
+        void start(const std::string& fp, PieceTable contents);
+        // blocks until the current save is done
+        void finish();
+
+        /* Returns true once after a save has finished,
+        * succeeded() and error() tell how it went.
+        */
+        bool poll();
+
+        bool saving() const { return m_saving; }
+        // between 0 and 1
+        float progress() const;
+
+        const std::string& path() const { return m_path; }
+        bool succeeded() const { return m_error.empty(); }
+        const std::string& error() const { return m_error; }
+
+    private:
+        void write();
+
+    private:
+        std::thread m_thread;
+
+        std::string m_path;
+        PieceTable m_contents;
+
+        // only touched by the worker until m_done is set
+        std::string m_error;
+
+        std::atomic<bool> m_done{ false };
+        std::atomic<size_t> m_bytes_written{ 0 };
+        size_t m_bytes_total{ 0 };
+
+        bool m_saving{ false };
+    };
+}
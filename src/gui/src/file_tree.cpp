@@ -10,480 +10,905 @@
 #  define PATH_SLASH '/'
 #endif /* if defined(_WIN32) */
 
+// texture memory for the names of files and folders
+#define NAME_TEXTURE_BUDGET (16 * 1024 * 1024)
+// memory collapsed folders can keep their contents in
+#define COLLAPSED_BUDGET (32 * 1024 * 1024)
+
 #define unique(ptr) std::unique_ptr<SDL_Texture, common::TextureDeleter>(ptr)
 
 namespace fs = std::filesystem;
 
 
-gui::File::File(const std::string& base_path, const Text& name, SDL_Renderer* rend)
-    : m_base_path(base_path), m_name(name), m_rect{ 0, 0, 0, 0 }
+gui::File::File(const std::string& base_path, const std::string& name)
+    : m_rect{ 0, 0, 0, 0 }, m_base_path(base_path), m_name(name)
 {
-    m_tex = unique(common::render_text(rend, m_name.font(), m_name.str().c_str(), m_name.color()));
 }
 
 
-void gui::File::render(SDL_Renderer* rend, int offset, int top_y, std::map<std::string, std::unique_ptr<SDL_Texture, common::TextureDeleter>>& file_textures, std::vector<std::string>& unsaved_files)
+std::string gui::File::path()
 {
-    if (m_rect.y >= top_y)
-    {
-        SDL_Rect text_rect = {
-            m_rect.x + offset,
-            m_rect.y
-        };
+    return m_base_path + PATH_SLASH + m_name;
+}
+
+
+gui::Folder::Folder(const std::string& base_path, const std::string& name)
+    : m_rect{ 0, 0, 0, 0 }, m_base_path(base_path), m_name(name), m_collapsed(true)
+{
+}
 
-        SDL_QueryTexture(m_tex.get(), nullptr, nullptr, &text_rect.w, &text_rect.h);
-        SDL_RenderCopy(rend, m_tex.get(), nullptr, &text_rect);
 
-        SDL_Rect icon_rect = {
-            text_rect.x - m_name.char_dim().x * 2 - 2,
-            text_rect.y,
-            m_name.char_dim().y,
-            m_name.char_dim().y
-        };
+void gui::Folder::add_entries(const std::vector<DirectoryScanner::Entry>& entries)
+{
+    std::string base_path = m_base_path + (m_name.empty() ? "" : PATH_SLASH + m_name);
 
-        // not unsaved
-        if (std::find(unsaved_files.begin(), unsaved_files.end(), path()) == unsaved_files.end())
-            SDL_RenderCopy(rend, file_textures["na"].get(), nullptr, &icon_rect);
+    for (auto& entry : entries)
+    {
+        // nothing is rendered here, names are rendered by the tree once they are on screen
+        if (entry.directory)
+        {
+            m_folders.emplace_back(Folder(base_path, entry.name));
+        }
         else
-            SDL_RenderCopy(rend, file_textures["na_unsaved"].get(), nullptr, &icon_rect);
+        {
+            m_files.emplace_back(File(base_path, entry.name));
+        }
     }
 }
 
 
-std::string gui::File::path()
+std::vector<gui::Folder> gui::Folder::merge_entries(const std::vector<DirectoryScanner::Entry>& entries)
 {
-    return m_base_path + PATH_SLASH + m_name.str();
-}
+    std::vector<File> files;
+    std::vector<Folder> folders;
 
+    std::unordered_map<std::string_view, size_t> old_files, old_folders;
 
-gui::Folder::Folder(const std::string& base_path, const Text& name, SDL_Renderer* rend, bool load_directory)
-    : m_base_path(base_path), m_name(name), m_rect{ 0, 0, 0, 0 }, m_loaded(load_directory)
-{
-    if (load_directory)
-        load(rend);
+    for (size_t i = 0; i < m_files.size(); ++i)
+        old_files[m_files[i].name()] = i;
+
+    for (size_t i = 0; i < m_folders.size(); ++i)
+        old_folders[m_folders[i].name()] = i;
+
+    std::vector<DirectoryScanner::Entry> added;
+
+    // kept in the order they were listed in, same as if the folder was loaded from scratch
+    for (auto& entry : entries)
+    {
+        auto& old = entry.directory ? old_folders : old_files;
+        auto it = old.find(entry.name);
+
+        if (it == old.end())
+        {
+            added.push_back(entry);
+            continue;
+        }
+
+        // the key points into the name that is about to be moved away
+        size_t i = it->second;
+        old.erase(it);
+
+        if (entry.directory)
+            folders.emplace_back(std::move(m_folders[i]));
+        else
+            files.emplace_back(std::move(m_files[i]));
+    }
+
+    // whatever wasnt found again is gone
+    std::vector<Folder> removed;
 
-    m_tex = unique(common::render_text(rend, m_name.font(), m_name.str().c_str(), m_name.color()));
+    for (auto& [name, i] : old_folders)
+        removed.emplace_back(std::move(m_folders[i]));
+
+    m_files = std::move(files);
+    m_folders = std::move(folders);
+
+    add_entries(added);
+
+    return removed;
 }
 
 
-void gui::Folder::render(SDL_Renderer* rend, int offset, SDL_Texture* closed_tex, SDL_Texture* opened_tex, int top_y, std::map<std::string, std::unique_ptr<SDL_Texture, common::TextureDeleter>>& file_textures, std::vector<std::string>& unsaved_files)
+std::vector<gui::Folder> gui::Folder::apply_changes(const std::vector<DirectoryWatcher::Change>& changes)
 {
-    if (m_rect.y >= top_y)
+    // whether each entry that changed exists in the end, and the order they first changed in
+    std::unordered_map<std::string, bool> files, folders;
+    std::vector<DirectoryScanner::Entry> changed;
+
+    for (auto& change : changes)
     {
-        SDL_Rect text_rect = {
-            m_rect.x + offset,
-            m_rect.y
-        };
+        auto& exists = change.directory ? folders : files;
+
+        if (exists.find(change.name) == exists.end())
+            changed.push_back({ change.name, change.directory });
+
+        exists[change.name] = change.exists;
+    }
 
-        SDL_QueryTexture(m_tex.get(), nullptr, nullptr, &text_rect.w, &text_rect.h);
-        SDL_RenderCopy(rend, m_tex.get(), nullptr, &text_rect);
+    std::vector<File> kept_files;
+    std::vector<Folder> kept_folders, removed;
 
-        SDL_Rect folder_rect = {
-            text_rect.x - m_name.char_dim().x * 2 - 2,
-            text_rect.y,
-            m_name.char_dim().y,
-            m_name.char_dim().y
-        };
+    for (auto& file : m_files)
+    {
+        auto it = files.find(file.name());
 
-        if (m_collapsed)
+        if (it == files.end() || it->second)
         {
-            SDL_RenderCopy(rend, closed_tex, nullptr, &folder_rect);
-            return;
+            // already there, so it isnt added again
+            if (it != files.end())
+                files.erase(it);
+
+            kept_files.emplace_back(std::move(file));
+        }
+    }
+
+    for (auto& folder : m_folders)
+    {
+        auto it = folders.find(folder.name());
+
+        if (it == folders.end() || it->second)
+        {
+            if (it != folders.end())
+                folders.erase(it);
+
+            kept_folders.emplace_back(std::move(folder));
         }
         else
         {
-            SDL_RenderCopy(rend, opened_tex, nullptr, &folder_rect);
+            removed.emplace_back(std::move(folder));
         }
     }
 
-    for (auto& folder : m_folders)
+    m_files = std::move(kept_files);
+    m_folders = std::move(kept_folders);
+
+    std::vector<DirectoryScanner::Entry> added;
+
+    for (auto& entry : changed)
     {
-        folder.render(rend, offset + 10, closed_tex, opened_tex, top_y, file_textures, unsaved_files);
+        auto& exists = entry.directory ? folders : files;
+        auto it = exists.find(entry.name);
+
+        if (it != exists.end() && it->second)
+            added.push_back(entry);
     }
 
+    add_entries(added);
+
+    return removed;
+}
+
+
+void gui::Folder::set_collapsed(bool collapsed)
+{
+    m_collapsed = collapsed;
+
+    if (collapsed)
+        m_memory = contents_memory();
+}
+
+
+std::string gui::Folder::directory()
+{
+    return m_base_path + PATH_SLASH + m_name;
+}
+
+
+void gui::Folder::unload()
+{
+    // clear keeps the capacity around
+    m_files = std::vector<File>();
+    m_folders = std::vector<Folder>();
+
+    m_loaded = false;
+    m_mtime = fs::file_time_type::min();
+    m_memory = 0;
+}
+
+
+size_t gui::Folder::contents_memory() const
+{
+    // everything inside of here has a copy of the path to it
+    size_t path = m_base_path.size() + m_name.size() + 1;
+    size_t bytes = m_files.capacity() * sizeof(File) + m_folders.capacity() * sizeof(Folder);
+
     for (auto& file : m_files)
-    {
-        file.render(rend, offset + 10, top_y, file_textures, unsaved_files);
-    }
+        bytes += file.name().capacity() + path;
+
+    for (auto& folder : m_folders)
+        bytes += folder.name().capacity() + path + folder.contents_memory();
+
+    return bytes;
 }
 
 
-void gui::Folder::collapse(SDL_Renderer* rend)
+gui::Tree::Tree(SDL_Rect rect, Folder& folder, SDL_Rect starting_rect, common::Font& font, SDL_Renderer* rend)
+    : m_rect(rect), m_folder(std::move(folder)), m_default_rect(starting_rect), m_collapsed_budget(COLLAPSED_BUDGET), m_name_textures(NAME_TEXTURE_BUDGET),
+    m_font(font.font()), m_text_color{ 255, 255, 255, 255 }, m_char_dim(font.char_dim())
 {
-    if (!m_collapsed)
-    {
-        m_collapsed = true;
+    m_closed_folder_texture = unique(IMG_LoadTexture(rend, "res/folder_closed.png"));
+    m_opened_folder_texture = unique(IMG_LoadTexture(rend, "res/folder_open.png"));
 
-        unload();
-    }
-    else
-    {
-        m_collapsed = false;
-        load(rend);
+    m_file_texture = unique(IMG_LoadTexture(rend, "res/file_na.png"));
+    m_unsaved_file_texture = unique(IMG_LoadTexture(rend, "res/file_na_unsaved.png"));
 
-        for (auto& f : m_folders)
-        {
-            f.collapse(rend);
-        }
+    // the root is listed in the background too unless it was already loaded
+    if (m_folder.collapsed())
+    {
+        m_folder.set_collapsed(false);
+        start_scan(m_folder);
     }
+
+    update_display();
 }
 
 
-void gui::Folder::update_rects(SDL_Rect& rect)
+void gui::Tree::render(SDL_Renderer* rend)
 {
-    m_rect = rect;
-    rect.y += m_name.char_dim().y;
+    m_dirty = false;
 
-    if (m_collapsed)
-        return;
+    if (!m_atlas)
+        m_atlas = std::make_unique<GlyphAtlas>(rend, m_font, m_char_dim);
 
-    for (auto& folder : m_folders)
+    auto [first, last] = visible_rows();
+
+    for (int i = first; i < last; ++i)
     {
-        folder.update_rects(rect);
+        render_row(rend, i);
     }
 
-    for (auto& file : m_files)
+    m_atlas->render();
+
+    if (m_selected_highlight_rect.y >= m_rect.y)
     {
-        file.update_rect(rect);
+        SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(rend, 255, 255, 255, 100);
+        SDL_RenderFillRect(rend, &m_selected_highlight_rect);
+        SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_NONE);
     }
 }
 
 
-void gui::Folder::load(SDL_Renderer* rend)
+void gui::Tree::update()
 {
-    m_folders.clear();
-    m_files.clear();
+    apply_changes(m_watcher.take());
 
-    Text t = m_name;
-    std::string sname = m_name.str();
-
-    std::error_code ec;
-    for (auto& entry : fs::directory_iterator(m_base_path + PATH_SLASH + sname, fs::directory_options::skip_permission_denied, ec))
+    for (auto& batch : m_scanner.take())
     {
-        if (ec)
+        int row;
+        Folder* folder = scanning_folder(batch.id, row);
+
+        // collapsed or gone since the scan started
+        if (!folder)
+        {
+            m_rescanned.erase(batch.id);
             continue;
+        }
 
-        std::string file_path = entry.path().filename().string();
-        std::string ext = fs::path(file_path).extension().string();
+        // listed for the first time, shown as it comes in
+        if (!folder->loaded())
+        {
+            folder->add_entries(batch.entries);
 
-        if (fs::path(file_path).has_extension() && ext[ext.size() - 1] == '~')
-            continue;
+            if (batch.done)
+            {
+                folder->set_scan(0);
+                folder->set_loaded(batch.mtime);
+            }
 
-        t.set_contents({ file_path });
-        
+            refresh_rows(row);
 
-        if (entry.is_directory())
-        {
-            m_folders.emplace_back(Folder(m_base_path + (sname.empty() ? "" : PATH_SLASH + sname), t, rend, false));
+            if (batch.done)
+                apply_deferred_changes(*folder, row);
+
+            continue;
         }
-        else
+
+        // already showing what it had before, which stays until the whole directory is listed
+        auto& entries = m_rescanned[batch.id];
+        entries.insert(entries.end(), std::make_move_iterator(batch.entries.begin()), std::make_move_iterator(batch.entries.end()));
+
+        if (!batch.done)
+            continue;
+
+        folder->set_scan(0);
+
+        if (!batch.unchanged)
         {
-            m_files.emplace_back(File(m_base_path + (sname.empty() ? "" : PATH_SLASH + sname), t, rend));
+            for (auto& removed : folder->merge_entries(entries))
+                forget(removed);
+
+            folder->set_loaded(batch.mtime);
+
+            refresh_rows(row);
         }
+
+        m_rescanned.erase(batch.id);
+        apply_deferred_changes(*folder, row);
     }
 }
 
 
-void gui::Folder::unload()
+gui::File* gui::Tree::check_file_click(int mx, int my)
 {
-    m_files.clear();
-    m_folders.clear();
+    int i = row_at(my);
+
+    if (i == -1 || !m_rows[i].file || !common::within_rect(m_rows[i].file->rect(), mx, my))
+        return nullptr;
+
+    return m_rows[i].file;
 }
 
 
-void gui::Folder::change_directory(const std::string& fp, SDL_Renderer* rend)
+gui::Folder* gui::Tree::check_folder_click(int mx, int my)
 {
-    fs::path p(fp);
+    int i = row_at(my);
+
+    if (i == -1 || !m_rows[i].folder || !common::within_rect(m_rows[i].folder->rect(), mx, my))
+        return nullptr;
 
-    m_base_path = p.parent_path().string();
-    m_name.set_contents({ p.filename().string() });
+    return m_rows[i].folder;
+}
 
-    load(rend);
 
-    for (auto& f : m_folders)
+void gui::Tree::collapse_folder(Folder& folder)
+{
+    auto it = std::find_if(m_rows.begin(), m_rows.end(), [&folder](const Row& row) { return row.folder == &folder; });
+
+    // not on any row, so there is nothing beneath it to insert or remove, it is listed in the background all the same
+    if (it == m_rows.end())
     {
-        f.collapse(rend);
+        if (!folder.collapsed())
+        {
+            stop_updates(folder);
+            folder.set_collapsed(true);
+            folder.set_collapsed_at(++m_collapse_count);
+        }
+        else
+        {
+            folder.set_collapsed(false);
+
+            if (!folder.loaded())
+                start_scan(folder);
+            else
+                revalidate(folder);
+        }
+
+        update_display();
+        return;
     }
-}
 
+    size_t i = it - m_rows.begin();
 
-gui::Folder* gui::Folder::find_lowest_folder()
-{
-    if (m_folders.empty())
-        return 0;
+    if (folder.collapsed())
+    {
+        folder.set_collapsed(false);
 
-    Folder* f = m_folders[m_folders.size() - 1].find_lowest_folder();
+        if (!folder.loaded())
+        {
+            start_scan(folder);
+            refresh_rows((int)i);
+            return;
+        }
 
-    if (!f)
-        return &m_folders[m_folders.size() - 1];
+        // everything that was expanded inside shows up again right away, and is checked for changes afterwards
+        refresh_rows((int)i);
+        revalidate(i, subtree_end(i));
+    }
     else
     {
-        Folder* tmp = f->find_lowest_folder();
+        // anything inside that is still loading wont be shown anymore, and is checked again once it is expanded
+        stop_updates(i, subtree_end(i));
 
-        if (tmp)
-            return tmp;
-        else
-            return f;
+        folder.set_collapsed(true);
+        folder.set_collapsed_at(++m_collapse_count);
+
+        refresh_rows((int)i);
+        evict_collapsed();
     }
 }
 
 
-gui::File* gui::Folder::find_lowest_file()
+void gui::Tree::change_directory(const std::string& fp)
+{
+    stop_updates(0, m_rows.size());
+    stop_updates(m_folder);
+
+    fs::path p(fp);
+
+    m_folder = Folder(p.parent_path().string(), p.filename().string());
+    m_folder.set_collapsed(false);
+    start_scan(m_folder);
+
+    // back to the top, the old scroll position could be past the end of the new folder
+    m_selected_highlight_rect.y -= m_default_rect.y - m_rect.y;
+    m_default_rect.y = m_rect.y;
+
+    update_display();
+}
+
+
+void gui::Tree::update_display()
 {
-    if (m_files.empty())
-        return 0;
+    m_rows.clear();
+    append_rows(m_folder, 0, m_rows);
 
-    return &m_files[m_files.size() - 1];
+    update_rects();
 }
 
 
-gui::Folder* gui::Folder::find_last_folder_with_files()
+void gui::Tree::scroll(int y, int window_h)
 {
-    if (!m_files.empty())
-        return this;
+    int char_height = m_char_dim.y;
+    // where the last row is, on screen or not
+    int bottom_y = m_default_rect.y + ((int)m_rows.size() - 1) * char_height;
 
-    for (int i = m_folders.size() - 1; i >= 0; --i)
+    if (m_default_rect.y - y * char_height <= m_rect.y)
     {
-        Folder* tmp = m_folders[i].find_last_folder_with_files();
-
-        if (tmp)
-            return tmp;
+        if (y > 0) // scrolling downwards, everything moves up
+        {
+            if (bottom_y + char_height - y * char_height + char_height >= window_h)
+            {
+                m_default_rect.y -= char_height * y;
+                m_selected_highlight_rect.y -= char_height * y;
+            }
+        }
+        else // scrolling upwards, everything moves down
+        {
+            m_default_rect.y -= char_height * y;
+            m_selected_highlight_rect.y -= char_height * y;
+        }
     }
 
-    return 0;
+    update_rects();
 }
 
 
-SDL_Rect gui::Folder::find_lowest_rect()
+void gui::Tree::append_unsaved_file(const std::string& fp, SDL_Window* window)
 {
-    Folder* f = find_lowest_folder();
+    if (fp.empty())
+        return;
 
-    if (!f)
+    if (m_unsaved_files.insert(fp).second)
     {
-        if (m_files.empty())
-            return m_rect;
-        else
-        {
-            File* file = find_lowest_file();
+        ++m_unsaved_version;
+        m_dirty = true;
 
-            return file->rect();
-        }
+        SDL_SetWindowTitle(window, (std::string(SDL_GetWindowTitle(window)) + std::string(" - UNSAVED")).c_str());
     }
-    
-    File* file = find_lowest_file();
+}
 
-    if (file)
-        return file->rect();
-    else
-    {
-        Folder* first_folder = find_last_folder_with_files();
 
-        if (first_folder)
-            file = first_folder->find_lowest_file();
+void gui::Tree::erase_unsaved_file(const std::string& fp, SDL_Window* window)
+{
+    if (m_unsaved_files.erase(fp))
+    {
+        ++m_unsaved_version;
+        m_dirty = true;
 
-        if (file)
-            return file->rect();
-        else
-            return f->rect();
+        std::string title = SDL_GetWindowTitle(window);
+        title = title.substr(0, title.size() - std::string(" - UNSAVED").size());
+        
+        SDL_SetWindowTitle(window, title.c_str());
     }
 }
 
 
-gui::Tree::Tree(SDL_Rect rect, Folder& folder, SDL_Rect starting_rect, SDL_Renderer* rend)
-    : m_folder(std::move(folder)), m_default_rect(starting_rect), m_rect(rect)
+bool gui::Tree::is_unsaved(const std::string& fp)
 {
-    m_closed_folder_texture = unique(IMG_LoadTexture(rend, "res/folder_closed.png"));
-    m_opened_folder_texture = unique(IMG_LoadTexture(rend, "res/folder_open.png"));
+    return m_unsaved_files.count(fp) != 0;
+}
+
 
-    m_file_textures["na"] = unique(IMG_LoadTexture(rend, "res/file_na.png"));
-    m_file_textures["na_unsaved"] = unique(IMG_LoadTexture(rend, "res/file_na_unsaved.png"));
+bool gui::Tree::is_unsaved(File& file)
+{
+    if (file.unsaved_version() != m_unsaved_version)
+        file.set_unsaved(!m_unsaved_files.empty() && is_unsaved(file.path()), m_unsaved_version);
+
+    return file.unsaved();
 }
 
 
-void gui::Tree::render(SDL_Renderer* rend)
+void gui::Tree::highlight_element(SDL_Renderer* rend, int mx, int my)
 {
-    SDL_Rect rect = m_default_rect;
-    int offset = 20;
+    if (row_at(my) == -1)
+        return;
+
+    SDL_Rect rect = {
+        m_rect.x,
+        (int)((my - m_rect.y) / m_char_dim.y) * m_char_dim.y + m_rect.y,
+        m_rect.w,
+        m_char_dim.y
+    };
 
-    for (auto& folder : m_folder.folders())
+    SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(rend, 255, 255, 255, 50);
+    SDL_RenderFillRect(rend, &rect);
+    SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_NONE);
+}
+
+
+void gui::Tree::update_hover(int mx, int my)
+{
+    int row = -1;
+
+    if (common::within_rect(m_rect, mx, my))
+        row = (my - m_rect.y) / m_char_dim.y;
+
+    if (row != m_hover_row)
     {
-        folder.render(rend, offset, m_closed_folder_texture.get(), m_opened_folder_texture.get(), m_rect.y, m_file_textures, m_unsaved_files);
+        m_hover_row = row;
+        m_dirty = true;
     }
+}
 
-    for (auto& file : m_folder.files())
+
+void gui::Tree::append_rows(Folder& folder, int depth, std::vector<Row>& rows)
+{
+    for (auto& f : folder.folders())
     {
-        file.render(rend, offset, m_rect.y, m_file_textures, m_unsaved_files);
+        rows.push_back({ &f, nullptr, depth });
+
+        if (!f.collapsed())
+            append_rows(f, depth + 1, rows);
     }
 
-    if (m_selected_highlight_rect.y >= m_rect.y)
+    for (auto& file : folder.files())
     {
-        SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_BLEND);
-        SDL_SetRenderDrawColor(rend, 255, 255, 255, 100);
-        SDL_RenderFillRect(rend, &m_selected_highlight_rect);
-        SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_NONE);
+        rows.push_back({ nullptr, &file, depth });
     }
+
+    if (folder.scan())
+        rows.push_back({ nullptr, nullptr, depth });
 }
 
 
-gui::File* gui::Tree::check_file_click(Folder& folder, int mx, int my)
+size_t gui::Tree::subtree_end(size_t i)
 {
-    if (my < m_rect.y)
-        return nullptr;
+    size_t end = i + 1;
 
-    for (auto& file : folder.files())
+    while (end < m_rows.size() && m_rows[end].depth > m_rows[i].depth)
+        ++end;
+
+    return end;
+}
+
+
+void gui::Tree::refresh_rows(int i)
+{
+    if (i < 0)
     {
-        if (common::within_rect(file.rect(), mx, my))
-        {
-            return &file;
-        }
+        update_display();
+        return;
     }
 
-    for (auto& f : folder.folders())
+    Folder& folder = *m_rows[i].folder;
+    int depth = m_rows[i].depth;
+
+    // the old rows can point at contents that are gone already, only their depth is looked at
+    m_rows.erase(m_rows.begin() + i + 1, m_rows.begin() + subtree_end(i));
+
+    if (!folder.collapsed())
     {
-        File* file = check_file_click(f, mx, my);
+        std::vector<Row> rows;
+        append_rows(folder, depth + 1, rows);
 
-        if (file)
-        {
-            return file;
-        }
+        m_rows.insert(m_rows.begin() + i + 1, rows.begin(), rows.end());
     }
 
-    return nullptr;
+    update_rects();
 }
 
 
-gui::Folder* gui::Tree::check_folder_click(Folder& folder, int mx, int my)
+void gui::Tree::start_scan(Folder& folder)
 {
-    if (my < m_rect.y)
-        return nullptr;
+    // watched first so nothing that happens while it is being listed is missed
+    if (!folder.watch())
+        folder.set_watch(m_watcher.watch(folder.directory()));
+
+    folder.unload();
+    folder.set_scan(m_scanner.scan(folder.directory()));
+}
+
 
-    if (common::within_rect(folder.rect(), mx, my))
+void gui::Tree::revalidate(size_t first, size_t last)
+{
+    for (size_t i = first; i < last; ++i)
     {
-        return &folder;
+        if (m_rows[i].folder)
+            revalidate(*m_rows[i].folder);
     }
+}
 
-    for (auto& f : folder.folders())
+
+void gui::Tree::revalidate(Folder& folder)
+{
+    if (folder.collapsed() || !folder.loaded())
+        return;
+
+    if (!folder.watch())
+        folder.set_watch(m_watcher.watch(folder.directory()));
+
+    if (!folder.scan())
+        folder.set_scan(m_scanner.scan(folder.directory(), folder.mtime()));
+}
+
+
+void gui::Tree::stop_updates(size_t first, size_t last)
+{
+    for (size_t i = first; i < last; ++i)
     {
-        if (common::within_rect(f.rect(), mx, my))
-            return &f;
+        if (m_rows[i].folder)
+            stop_updates(*m_rows[i].folder);
+    }
+}
 
-        Folder* fold = check_folder_click(f, mx, my);
 
-        if (fold)
-            return fold;
+void gui::Tree::stop_updates(Folder& folder)
+{
+    if (folder.watch())
+    {
+        m_watcher.unwatch(folder.watch());
+        m_deferred_changes.erase(folder.watch());
+        folder.set_watch(0);
     }
 
-    return nullptr;
+    if (!folder.scan())
+        return;
+
+    m_scanner.cancel(folder.scan());
+    m_rescanned.erase(folder.scan());
+    folder.set_scan(0);
+
+    // half of a folder would look like all of it the next time it is expanded
+    if (!folder.loaded())
+        folder.unload();
 }
 
 
-void gui::Tree::collapse_folder(Folder& folder, SDL_Renderer* rend)
+void gui::Tree::forget(Folder& folder)
 {
-    folder.collapse(rend);
+    stop_updates(folder);
+
+    for (auto& f : folder.folders())
+        forget(f);
 }
 
 
-void gui::Tree::update_display()
+void gui::Tree::apply_changes(DirectoryWatcher::Changes changes)
 {
-    SDL_Rect rect = m_default_rect;
-    int offset = 20;
-
-    for (auto& folder : m_folder.folders())
+    // some changes were lost, so whatever is expanded is checked against the disk again
+    if (changes.overflowed)
     {
-        folder.update_rects(rect);
+        revalidate(m_folder);
+        revalidate(0, m_rows.size());
     }
 
-    for (auto& file : m_folder.files())
+    // changes are applied one folder at a time, in the order the folders first changed in
+    std::vector<int> order;
+    std::unordered_map<int, std::vector<DirectoryWatcher::Change>> by_watch;
+
+    for (auto& change : changes.changes)
     {
-        file.update_rect(rect);
-    }
-}
+        auto& folder_changes = by_watch[change.watch];
 
+        if (folder_changes.empty())
+            order.push_back(change.watch);
 
-void gui::Tree::scroll(int y, int window_h)
-{
-    //File& last_file = m_folder.files()[m_folder.files().size() - 1];
-    SDL_Rect bottom_rect = m_folder.find_lowest_rect();
-    int char_height = m_folder.name().char_dim().y;
+        folder_changes.emplace_back(std::move(change));
+    }
 
-    if (m_default_rect.y - y * char_height <= m_rect.y)
+    for (int watch : order)
     {
-        if (y > 0) // scrolling downwards, everything moves up
+        auto& folder_changes = by_watch[watch];
+
+        // looked up again every time, applying changes can move the folders around
+        int row;
+        Folder* folder;
+
+        for (size_t nth = 0; (folder = watched_folder(watch, row, nth)); ++nth)
         {
-            if (bottom_rect.y + bottom_rect.h - y * char_height + char_height >= window_h)
+            // whatever is being listed wouldnt know about these, so they wait until it is done
+            if (folder->scan())
             {
-                m_default_rect.y -= char_height * y;
-                m_selected_highlight_rect.y -= char_height * y;
+                auto& deferred = m_deferred_changes[watch];
+                deferred.insert(deferred.end(), folder_changes.begin(), folder_changes.end());
+                continue;
             }
-        }
-        else // scrolling upwards, everything moves down
-        {
-            m_default_rect.y -= char_height * y;
-            m_selected_highlight_rect.y -= char_height * y;
+
+            for (auto& removed : folder->apply_changes(folder_changes))
+                forget(removed);
+
+            refresh_rows(row);
         }
     }
-
-    update_display();
 }
 
 
-void gui::Tree::append_unsaved_file(const std::string& fp, SDL_Window* window)
+void gui::Tree::apply_deferred_changes(Folder& folder, int row)
 {
-    if (fp.empty())
+    auto it = m_deferred_changes.find(folder.watch());
+
+    if (!folder.watch() || it == m_deferred_changes.end())
         return;
 
-    if (std::find(m_unsaved_files.begin(), m_unsaved_files.end(), fp) == m_unsaved_files.end())
+    // entries that are already there arent added twice, so changes the listing already saw dont do anything
+    for (auto& removed : folder.apply_changes(it->second))
+        forget(removed);
+
+    m_deferred_changes.erase(it);
+
+    refresh_rows(row);
+}
+
+
+void gui::Tree::collect_collapsed(Folder& folder, std::vector<Folder*>& collapsed)
+{
+    for (auto& f : folder.folders())
     {
-        m_unsaved_files.emplace_back(fp);
-        SDL_SetWindowTitle(window, (std::string(SDL_GetWindowTitle(window)) + std::string(" - UNSAVED")).c_str());
+        if (!f.collapsed())
+            collect_collapsed(f, collapsed);
+        else if (f.loaded())
+            collapsed.emplace_back(&f);
     }
 }
 
 
-void gui::Tree::erase_unsaved_file(const std::string& fp, SDL_Window* window)
+void gui::Tree::evict_collapsed()
 {
-    auto pos = std::find(m_unsaved_files.begin(), m_unsaved_files.end(), fp);
+    std::vector<Folder*> collapsed;
+    collect_collapsed(m_folder, collapsed);
 
-    if (pos != m_unsaved_files.end())
+    size_t total = 0;
+
+    for (Folder* folder : collapsed)
+        total += folder->memory();
+
+    std::sort(collapsed.begin(), collapsed.end(), [](Folder* a, Folder* b) { return a->collapsed_at() < b->collapsed_at(); });
+
+    // collapsed folders arent in any rows, so nothing has to be rebuilt
+    for (size_t i = 0; i < collapsed.size() && total > m_collapsed_budget; ++i)
     {
-        m_unsaved_files.erase(pos);
+        total -= collapsed[i]->memory();
+        collapsed[i]->unload();
+    }
+}
 
-        std::string title = SDL_GetWindowTitle(window);
-        title = title.substr(0, title.size() - std::string(" - UNSAVED").size());
-        
-        SDL_SetWindowTitle(window, title.c_str());
 
-        if (fs::exists(fp + "~"))
+gui::Folder* gui::Tree::watched_folder(int watch, int& row, size_t nth)
+{
+    row = -1;
+
+    if (m_folder.watch() == watch && nth-- == 0)
+        return &m_folder;
+
+    for (size_t i = 0; i < m_rows.size(); ++i)
+    {
+        if (m_rows[i].folder && m_rows[i].folder->watch() == watch && nth-- == 0)
         {
-            fs::remove(fp + "~");
+            row = (int)i;
+            return m_rows[i].folder;
         }
     }
+
+    return nullptr;
 }
 
 
-bool gui::Tree::is_unsaved(const std::string& fp)
+gui::Folder* gui::Tree::scanning_folder(size_t id, int& row)
+{
+    row = -1;
+
+    if (m_folder.scan() == id)
+        return &m_folder;
+
+    for (size_t i = 0; i < m_rows.size(); ++i)
+    {
+        if (m_rows[i].folder && m_rows[i].folder->scan() == id)
+        {
+            row = (int)i;
+            return m_rows[i].folder;
+        }
+    }
+
+    return nullptr;
+}
+
+
+int gui::Tree::row_at(int my)
 {
-    return std::find(m_unsaved_files.begin(), m_unsaved_files.end(), fp) != m_unsaved_files.end();
+    if (my < m_rect.y || my >= m_rect.y + m_rect.h)
+        return -1;
+
+    int i = (my - m_default_rect.y) / m_char_dim.y;
+
+    if (i < 0 || i >= (int)m_rows.size())
+        return -1;
+
+    return i;
 }
 
 
-void gui::Tree::highlight_element(SDL_Renderer* rend, int mx, int my)
+std::pair<int, int> gui::Tree::visible_rows()
 {
-    SDL_Rect rect = {
-        m_rect.x,
-        (int)((my - m_rect.y) / m_folder.name().char_dim().y) * m_folder.name().char_dim().y + m_rect.y,
-        m_rect.w,
-        m_folder.name().char_dim().y
+    // rows start at m_default_rect.y, the ones above the top of the tree are scrolled out of view
+    int first = std::max(0, (m_rect.y - m_default_rect.y + m_char_dim.y - 1) / m_char_dim.y);
+    int last = std::min((int)m_rows.size(), (m_rect.y + m_rect.h - m_default_rect.y + m_char_dim.y - 1) / m_char_dim.y);
+
+    return { std::min(first, std::max(last, 0)), std::max(last, 0) };
+}
+
+
+void gui::Tree::update_rects()
+{
+    auto [first, last] = visible_rows();
+
+    for (int i = first; i < last; ++i)
+    {
+        if (m_rows[i].folder)
+            m_rows[i].folder->set_rect(row_rect(i));
+        else if (m_rows[i].file)
+            m_rows[i].file->set_rect(row_rect(i));
+    }
+
+    m_dirty = true;
+}
+
+
+SDL_Rect gui::Tree::row_rect(int i)
+{
+    return {
+        m_default_rect.x,
+        m_default_rect.y + i * m_char_dim.y,
+        m_default_rect.w,
+        m_char_dim.y
     };
+}
+
 
-    //File& bottom_file = m_folder.files()[m_folder.files().size() - 1];
-    SDL_Rect lowest_rect = m_folder.find_lowest_rect();
+void gui::Tree::render_row(SDL_Renderer* rend, int i)
+{
+    const Row& row = m_rows[i];
+    SDL_Rect rect = row_rect(i);
+
+    SDL_Rect text_rect = {
+        rect.x + 20 + row.depth * 10,
+        rect.y,
+        0, 0
+    };
 
-    if (rect.y > lowest_rect.y)
+    if (!row.folder && !row.file)
+    {
+        m_atlas->add_text("loading...", text_rect.x, text_rect.y, { 150, 150, 150, 255 });
         return;
+    }
 
-    SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(rend, 255, 255, 255, 50);
-    SDL_RenderFillRect(rend, &rect);
-    SDL_SetRenderDrawBlendMode(rend, SDL_BLENDMODE_NONE);
+    const std::string& name = row.folder ? row.folder->name() : row.file->name();
+
+    // the atlas has one cell per byte, so multibyte characters have to be rendered by ttf
+    if (std::all_of(name.begin(), name.end(), [](char c) { return (unsigned char)c < 128; }))
+    {
+        m_atlas->add_text(name, text_rect.x, text_rect.y, m_text_color);
+    }
+    else
+    {
+        SDL_Texture* tex = m_name_textures.get(rend, m_font, name, m_text_color);
+
+        SDL_QueryTexture(tex, nullptr, nullptr, &text_rect.w, &text_rect.h);
+        SDL_RenderCopy(rend, tex, nullptr, &text_rect);
+    }
+
+    SDL_Rect icon_rect = {
+        text_rect.x - m_char_dim.x * 2 - 2,
+        text_rect.y,
+        m_char_dim.y,
+        m_char_dim.y
+    };
+
+    if (row.folder)
+        SDL_RenderCopy(rend, row.folder->collapsed() ? m_closed_folder_texture.get() : m_opened_folder_texture.get(), nullptr, &icon_rect);
+    else if (!is_unsaved(*row.file))
+        SDL_RenderCopy(rend, m_file_texture.get(), nullptr, &icon_rect);
+    else
+        SDL_RenderCopy(rend, m_unsaved_file_texture.get(), nullptr, &icon_rect);
 }
\ No newline at end of file
@@ -1,10 +1,18 @@
 #pragma once
-#include "text.h"
 #include "common.h"
+#include "texture_cache.h"
+#include "glyph_atlas.h"
+#include "directory_scanner.h"
+#include "directory_watcher.h"
 #include <string>
+#include <string_view>
 #include <vector>
+#include <utility>
 #include <memory>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <filesystem>
+#include <cstdint>
 
 
 namespace gui
@@ -13,91 +21,137 @@ namespace gui
     {
     public:
         File() = default;
-        File(const std::string& base_path, const Text& name, SDL_Renderer* rend);
-
-        void render(SDL_Renderer* rend, int offset, int top_y, std::map<std::string, std::unique_ptr<SDL_Texture, common::TextureDeleter>>& file_textures, std::vector<std::string>& unsaved_files);
-
-        void update_rect(SDL_Rect& r) { m_rect = r; r.y += m_name.char_dim().y; }
+        File(const std::string& base_path, const std::string& name);
 
         std::string path();
-        Text name() const { return m_name; }
+        const std::string& name() const { return m_name; }
         SDL_Rect rect() const { return m_rect; }
 
+        void set_rect(SDL_Rect rect) { m_rect = rect; }
         void reset_rect() { m_rect = { -1, -1, -1, -1 }; }
 
+        /* Whether the file has unsaved changes, as of the version of the unsaved files it was last checked against.
+        * Kept on the file so drawing it doesnt have to build its path and look it up.
+        */
+        bool unsaved() const { return m_unsaved; }
+        uint64_t unsaved_version() const { return m_unsaved_version; }
+        void set_unsaved(bool unsaved, uint64_t version) { m_unsaved = unsaved; m_unsaved_version = version; }
+
     private:
         SDL_Rect m_rect;
 
         std::string m_base_path;
-        Text m_name;
-
-        std::unique_ptr<SDL_Texture, common::TextureDeleter> m_tex;
+        std::string m_name;
 
-        bool m_saved{ true };
+        bool m_unsaved{ false };
+        // 0 is never a version, so new files are always checked once
+        uint64_t m_unsaved_version{ 0 };
     };
 
     class Folder
     {
     public:
-        Folder(const std::string& base_path, const Text& name, SDL_Renderer* rend, bool load_directory);
-
-        void render(SDL_Renderer* rend, int offset, SDL_Texture* closed_tex, SDL_Texture* opened_tex, int top_y, std::map<std::string, std::unique_ptr<SDL_Texture, common::TextureDeleter>>& file_textures, std::vector<std::string>& unsaved_files);
-
-        /* If already collapsed, folder will expand. */
-        void collapse(SDL_Renderer* rend);
-
-        /* Update where all the folders and files will be rendered. */
-        void update_rects(SDL_Rect& rect);
+        /* Folders start out collapsed and empty, the tree lists them in the background the first time they are expanded. */
+        Folder(const std::string& base_path, const std::string& name);
 
-        /* Load all the contents directly beneath this folder. This is used to save memory. */
-        void load(SDL_Renderer* rend);
-        /* Unload all the contents from the folder, normally called when the folder is closed. */
+        /* Unload all the contents from the folder, done once a collapsed folder has been out of view for a while. */
         void unload();
-
-        void change_directory(const std::string& fp, SDL_Renderer* rend);
-
-        Folder* find_lowest_folder();
-        File* find_lowest_file();
-        Folder* find_last_folder_with_files();
-
-        SDL_Rect find_lowest_rect();
-
+        // adds entries found in directory() to the contents
+        void add_entries(const std::vector<DirectoryScanner::Entry>& entries);
+        /* Replaces the contents with entries, anything that is still there keeps its contents and whether it was expanded.
+        * Returns the folders that arent there anymore.
+        */
+        std::vector<Folder> merge_entries(const std::vector<DirectoryScanner::Entry>& entries);
+        /* Adds and removes the entries that were created and deleted in directory(), in the order it happened.
+        * Returns the folders that were removed.
+        */
+        std::vector<Folder> apply_changes(const std::vector<DirectoryWatcher::Change>& changes);
+        // the contents are kept either way
+        void set_collapsed(bool collapsed);
+        // the contents are complete, as of the directory being last changed at mtime
+        void set_loaded(std::filesystem::file_time_type mtime) { m_loaded = true; m_mtime = mtime; }
 
         std::vector<File>& files() { return m_files; }
         std::vector<Folder>& folders() { return m_folders; }
-        Text name() const { return m_name; }
+        const std::string& name() const { return m_name; }
         SDL_Rect rect() const { return m_rect; }
-
+        bool collapsed() const { return m_collapsed; }
+        bool loaded() const { return m_loaded; }
+        std::filesystem::file_time_type mtime() const { return m_mtime; }
+        // the directory the contents come from
+        std::string directory();
+
+        // id of the scan still filling in the contents, 0 if there is none
+        size_t scan() const { return m_scan; }
+        void set_scan(size_t id) { m_scan = id; }
+
+        // the watch on directory(), 0 if it isnt being watched
+        int watch() const { return m_watch; }
+        void set_watch(int watch) { m_watch = watch; }
+
+        // older collapsed folders are unloaded first
+        uint64_t collapsed_at() const { return m_collapsed_at; }
+        void set_collapsed_at(uint64_t n) { m_collapsed_at = n; }
+        // roughly how many bytes the contents take up, worked out when the folder is collapsed
+        size_t memory() const { return m_memory; }
+
+        void set_rect(SDL_Rect rect) { m_rect = rect; }
         void reset_rect() { m_rect = { -1, -1, -1, -1 }; }
 
+    private:
+        size_t contents_memory() const;
+
     private:
         SDL_Rect m_rect;
 
         std::string m_base_path;
-        Text m_name;
+        // only the name is kept, it isnt rendered until its row is on screen
+        std::string m_name;
 
         std::vector<File> m_files;
         std::vector<Folder> m_folders;
 
-        std::unique_ptr<SDL_Texture, common::TextureDeleter> m_tex;
-
         bool m_collapsed{ false };
         bool m_loaded{ false };
+        std::filesystem::file_time_type m_mtime{ std::filesystem::file_time_type::min() };
+
+        size_t m_scan{ 0 };
+        int m_watch{ 0 };
+
+        uint64_t m_collapsed_at{ 0 };
+        size_t m_memory{ 0 };
     };
 
+    /* Everything that is expanded is kept as one flat list of rows in the order they are shown,
+    * so rendering only goes over the rows on screen and finding the row under the mouse is a division.
+    * Expanding or collapsing a folder only inserts or removes the rows beneath it.
+    * Folders are listed in the background, a loading row is shown beneath them until they are done.
+    * Collapsed folders keep their contents until they take up more than the collapsed budget, so expanding
+    * them again is instant. They are listed again in the background if the directory changed in the meantime.
+    * Expanded folders are watched, whatever is created or deleted in them shows up without listing them again.
+    */
     class Tree
     {
     public:
-        Tree(SDL_Rect rect, Folder& folder, SDL_Rect starting_rect, SDL_Renderer* rend);
+        // every name is drawn with font
+        Tree(SDL_Rect rect, Folder& folder, SDL_Rect starting_rect, common::Font& font, SDL_Renderer* rend);
 
         void render(SDL_Renderer* rend);
 
-        File* check_file_click(Folder& folder, int mx, int my);
-        Folder* check_folder_click(Folder& folder, int mx, int my);
+        // adds whatever the background scans found since the last call
+        void update();
+
+        // nullptr if (mx, my) isnt over a file
+        File* check_file_click(int mx, int my);
+        // nullptr if (mx, my) isnt over a folder
+        Folder* check_folder_click(int mx, int my);
 
         // collapses folder if not already collapsed, otherwise expands the folder
-        void collapse_folder(Folder& folder, SDL_Renderer* rend);
+        void collapse_folder(Folder& folder);
 
+        void change_directory(const std::string& fp);
+
+        /* Rebuilds every row, only needed when folders were changed without going through the tree. */
         void update_display();
 
         void scroll(int y, int window_h);
@@ -108,26 +162,124 @@ namespace gui
 
         // highlights a file / folder based off where mouse position is
         void highlight_element(SDL_Renderer* rend, int mx, int my);
-        void resize_to(int h) { m_rect.h = h; }
+        // keeps track of which row the mouse is over so the highlight is redrawn when it moves to another one
+        void update_hover(int mx, int my);
+        void resize_to(int h) { m_rect.h = h; update_rects(); }
+
+        // true if something changed since the last render
+        bool dirty() { return m_dirty; }
+        void invalidate() { m_dirty = true; }
 
-        void set_selected_highlight_rect(SDL_Rect rect) { m_selected_highlight_rect = rect; }
+        void set_selected_highlight_rect(SDL_Rect rect) { m_selected_highlight_rect = rect; m_dirty = true; }
         Folder& folder() { return m_folder; }
-        std::vector<std::string> unsaved() { return m_unsaved_files; }
+        const std::unordered_set<std::string>& unsaved() const { return m_unsaved_files; }
         SDL_Rect rect() { return m_rect; }
+        // amount of rows that are expanded, on screen or not
+        int row_count() const { return (int)m_rows.size(); }
+
+    private:
+        struct Row
+        {
+            // at most one of them is set, neither for the loading row of a folder, non owning, dont free
+            Folder* folder;
+            File* file;
+
+            // children of the root folder are at depth 0
+            int depth;
+        };
+
+        // adds rows for everything shown inside of folder, in the order they are shown
+        static void append_rows(Folder& folder, int depth, std::vector<Row>& rows);
+        // one past the last row inside of the folder at row i
+        size_t subtree_end(size_t i);
+        // rebuilds the rows inside of the folder at row i, -1 for the root folder
+        void refresh_rows(int i);
+
+        // starts listing folder again in the background
+        void start_scan(Folder& folder);
+        // checks the expanded folders in rows [first, last) against their directories in the background
+        void revalidate(size_t first, size_t last);
+        void revalidate(Folder& folder);
+
+        /* Cancels the scans of the folders in rows [first, last) and stops watching them.
+        * Folders that were only partly listed are unloaded.
+        */
+        void stop_updates(size_t first, size_t last);
+        void stop_updates(Folder& folder);
+        // stops updating folder and everything inside of it, for folders that are about to be destroyed
+        void forget(Folder& folder);
+
+        // applies the changes the watcher found to the folders they happened in
+        void apply_changes(DirectoryWatcher::Changes changes);
+        // applies the changes that came in while folder at row was being listed
+        void apply_deferred_changes(Folder& folder, int row);
+        // the nth folder being watched by watch, row is set to the row it is at
+        // more than one folder has the same watch when they are the same directory, through a symlink
+        Folder* watched_folder(int watch, int& row, size_t nth = 0);
+
+        // collapsed folders that still have their contents, not counting the ones inside of them
+        static void collect_collapsed(Folder& folder, std::vector<Folder*>& collapsed);
+        // unloads the folders that were collapsed the longest ago until the rest fit in the budget
+        void evict_collapsed();
+        // folder being filled in by scan id, row is set to the row it is at
+        Folder* scanning_folder(size_t id, int& row);
+
+        // row at the y position my, -1 if there is no row there
+        int row_at(int my);
+        // first row on screen and one past the last one
+        std::pair<int, int> visible_rows();
+        // gives the rows on screen their rects, everything else keeps whatever it had
+        void update_rects();
+        SDL_Rect row_rect(int i);
+
+        // names are queued in the atlas, which is drawn once every row is done
+        void render_row(SDL_Renderer* rend, int i);
+        // is_unsaved for a file in the tree, the path is only looked up if something was saved or changed since the last time
+        bool is_unsaved(File& file);
 
     private:
         SDL_Rect m_rect;
 
         Folder m_folder;
+        // x, width and height of every row, y is where the first row is
         SDL_Rect m_default_rect;
 
+        std::vector<Row> m_rows;
+
+        DirectoryScanner m_scanner;
+        // everything found so far by scans of folders that are already loaded, merged in once the scan is done
+        std::unordered_map<size_t, std::vector<DirectoryScanner::Entry>> m_rescanned;
+
+        DirectoryWatcher m_watcher;
+        // changes to folders that were being listed when they came in, by watch
+        std::unordered_map<int, std::vector<DirectoryWatcher::Change>> m_deferred_changes;
+
+        size_t m_collapsed_budget;
+        uint64_t m_collapse_count{ 0 };
+
         std::unique_ptr<SDL_Texture, common::TextureDeleter> m_opened_folder_texture;
         std::unique_ptr<SDL_Texture, common::TextureDeleter> m_closed_folder_texture;
 
-        std::map<std::string, std::unique_ptr<SDL_Texture, common::TextureDeleter>> m_file_textures;
+        std::unique_ptr<SDL_Texture, common::TextureDeleter> m_file_texture;
+        std::unique_ptr<SDL_Texture, common::TextureDeleter> m_unsaved_file_texture;
+        // names are only drawn once they are scrolled into view, plain ascii ones straight from the atlas
+        std::unique_ptr<GlyphAtlas> m_atlas;
+        // anything the atlas cant draw is rendered on its own and kept around while it fits in the budget
+        TextureCache m_name_textures;
+
+        // non owning, dont free
+        TTF_Font* m_font;
+        SDL_Color m_text_color;
+        SDL_Point m_char_dim;
 
-        std::vector<std::string> m_unsaved_files;
+        std::unordered_set<std::string> m_unsaved_files;
+        // changes whenever a file is added to or removed from m_unsaved_files
+        uint64_t m_unsaved_version{ 1 };
 
         SDL_Rect m_selected_highlight_rect{ 0, 0, 0, 0 };
+
+        // row the mouse is over, -1 if it isnt over any
+        int m_hover_row{ -1 };
+        bool m_dirty{ true };
     };
 }
\ No newline at end of file
@@ -0,0 +1,335 @@
+#include "folder_picker.h"
+#include <algorithm>
+#include <filesystem>
+#include <cstring>
+
+#if defined(_WIN32)
+#  define PATH_SLASH '\\'
+#else
+#  define PATH_SLASH '/'
+#endif /* if defined(_WIN32) */
+
+#define FOLDER_PICKER_WIDTH 600
+#define FOLDER_PICKER_HEIGHT 400
+#define FOLDER_PICKER_PADDING 6
+#define BUTTON_WIDTH 90
+#define BUTTON_HEIGHT 22
+// rasterized names that arent ascii, a screen of them is far less than this
+#define NAME_TEXTURE_BUDGET (4 * 1024 * 1024)
+
+namespace fs = std::filesystem;
+
+
+gui::FolderPicker::FolderPicker(common::Font& font)
+    // one folder is listed at a time
+    : m_scanner(1), m_name_textures(NAME_TEXTURE_BUDGET), m_font(font.font()), m_char_dim(font.char_dim())
+{
+}
+
+
+void gui::FolderPicker::show(const std::string& dir)
+{
+    m_shown = true;
+    m_has_picked = false;
+
+    open(dir);
+}
+
+
+void gui::FolderPicker::hide()
+{
+    m_shown = false;
+    m_dirty = true;
+
+    m_scanner.cancel(m_scan);
+    m_loading = false;
+}
+
+
+void gui::FolderPicker::mouse_down(int mx, int my, int clicks)
+{
+    if (!contains(mx, my))
+    {
+        hide();
+        return;
+    }
+
+    if (common::within_rect(select_rect(), mx, my))
+    {
+        pick();
+        return;
+    }
+
+    if (common::within_rect(cancel_rect(), mx, my))
+    {
+        hide();
+        return;
+    }
+
+    for (int row = m_first; row < std::min(row_count(), m_first + m_rows); ++row)
+    {
+        if (!common::within_rect(row_rect(row - m_first), mx, my))
+            continue;
+
+        m_selected = row;
+        m_dirty = true;
+
+        // going up only takes one click, like before
+        if (clicks >= 2 || row == 0)
+            open_selected();
+
+        return;
+    }
+}
+
+
+void gui::FolderPicker::key_down(SDL_Keycode key)
+{
+    switch (key)
+    {
+    case SDLK_ESCAPE:
+        hide();
+        break;
+    case SDLK_RETURN:
+        if (m_selected >= 0)
+            open_selected();
+        else
+            pick();
+        break;
+    case SDLK_BACKSPACE:
+        m_selected = 0;
+        open_selected();
+        break;
+    case SDLK_UP:
+        move_selection(-1);
+        break;
+    case SDLK_DOWN:
+        move_selection(1);
+        break;
+    }
+}
+
+
+void gui::FolderPicker::scroll(int rows)
+{
+    int first = std::clamp(m_first + rows, 0, std::max(0, row_count() - m_rows));
+
+    if (first == m_first)
+        return;
+
+    m_first = first;
+    m_dirty = true;
+}
+
+
+bool gui::FolderPicker::take_picked(std::string& path)
+{
+    if (!m_has_picked)
+        return false;
+
+    path = std::move(m_picked);
+    m_has_picked = false;
+
+    return true;
+}
+
+
+void gui::FolderPicker::update()
+{
+    for (auto& batch : m_scanner.take())
+    {
+        if (batch.id != m_scan)
+            continue;
+
+        for (auto& entry : batch.entries)
+        {
+            if (entry.directory)
+                m_names.emplace_back(std::move(entry.name));
+        }
+
+        if (batch.done)
+            m_loading = false;
+
+        m_dirty |= m_shown;
+    }
+}
+
+
+void gui::FolderPicker::render(SDL_Renderer* rend, int window_w, int window_h)
+{
+    m_dirty = false;
+
+    if (!m_shown)
+        return;
+
+    if (!m_atlas)
+        m_atlas = std::make_unique<GlyphAtlas>(rend, m_font, m_char_dim);
+
+    int w = std::min(FOLDER_PICKER_WIDTH, window_w - 40);
+    int h = std::min(FOLDER_PICKER_HEIGHT, window_h - 40);
+
+    m_rect = { (window_w - w) / 2, (window_h - h) / 2, w, h };
+    m_rows = std::max(1, (h - FOLDER_PICKER_PADDING * 3 - BUTTON_HEIGHT) / m_char_dim.y - 1);
+    m_first = std::clamp(m_first, 0, std::max(0, row_count() - m_rows));
+
+    SDL_SetRenderDrawColor(rend, 35, 35, 35, 255);
+    SDL_RenderFillRect(rend, &m_rect);
+    SDL_SetRenderDrawColor(rend, 90, 90, 90, 255);
+    SDL_RenderDrawRect(rend, &m_rect);
+
+    int x = m_rect.x + FOLDER_PICKER_PADDING;
+    int columns = (m_rect.w - FOLDER_PICKER_PADDING * 2) / m_char_dim.x;
+
+    // the end of a long path is cut off from the front, the folder it ends in is what matters
+    if ((int)m_dir.size() > columns)
+        m_atlas->add_text("..." + m_dir.substr(m_dir.size() - std::max(0, columns - 3)), x, m_rect.y + FOLDER_PICKER_PADDING, { 150, 150, 150, 255 });
+    else
+        m_atlas->add_text(m_dir, x, m_rect.y + FOLDER_PICKER_PADDING, { 150, 150, 150, 255 });
+
+    // only the rows on screen are drawn, the rest are never rasterized
+    int last = std::min(row_count(), m_first + m_rows);
+
+    for (int row = m_first; row < last; ++row)
+    {
+        SDL_Rect rect = row_rect(row - m_first);
+
+        if (row == m_selected)
+        {
+            SDL_SetRenderDrawColor(rend, 70, 70, 70, 255);
+            SDL_RenderFillRect(rend, &rect);
+        }
+
+        if (row == 0)
+        {
+            m_atlas->add_text("(Move up a directory)", x, rect.y, { 255, 255, 255, 255 });
+            continue;
+        }
+
+        const std::string& name = m_names[row - 1];
+
+        // the atlas has one cell per byte, so multibyte characters have to be rendered by ttf
+        if (std::all_of(name.begin(), name.end(), [](char c) { return (unsigned char)c < 128; }))
+        {
+            m_atlas->add_text(name, x, rect.y, { 255, 255, 255, 255 });
+        }
+        else
+        {
+            SDL_Texture* tex = m_name_textures.get(rend, m_font, name, { 255, 255, 255, 255 });
+            SDL_Rect text_rect = { x, rect.y, 0, 0 };
+
+            SDL_QueryTexture(tex, nullptr, nullptr, &text_rect.w, &text_rect.h);
+            SDL_RenderCopy(rend, tex, nullptr, &text_rect);
+        }
+    }
+
+    if (m_loading && last - m_first < m_rows)
+        m_atlas->add_text("loading...", x, row_rect(last - m_first).y, { 150, 150, 150, 255 });
+
+    render_button(rend, select_rect(), "Select");
+    render_button(rend, cancel_rect(), "Cancel");
+
+    m_atlas->render();
+}
+
+
+void gui::FolderPicker::open(const std::string& dir)
+{
+    std::error_code ec;
+    fs::path path = fs::absolute(dir, ec).lexically_normal();
+
+    // a trailing slash would end up in the picked path
+    if (!path.has_filename() && path != path.root_path())
+        path = path.parent_path();
+
+    m_scanner.cancel(m_scan);
+
+    m_dir = path.string();
+    m_scan = m_scanner.scan(m_dir);
+    m_names.clear();
+    m_loading = true;
+
+    m_selected = -1;
+    m_first = 0;
+    m_dirty = true;
+}
+
+
+void gui::FolderPicker::open_selected()
+{
+    if (m_selected == 0)
+        open(fs::path(m_dir).parent_path().string());
+    else if (m_selected > 0 && m_selected < row_count())
+        open(m_dir + (m_dir.back() == PATH_SLASH ? "" : std::string(1, PATH_SLASH)) + m_names[m_selected - 1]);
+}
+
+
+void gui::FolderPicker::pick()
+{
+    // the selected folder if there is one, otherwise the one being shown, same as the old dialog
+    m_picked = m_dir;
+
+    if (m_selected > 0 && m_selected < row_count())
+        m_picked += (m_dir.back() == PATH_SLASH ? "" : std::string(1, PATH_SLASH)) + m_names[m_selected - 1];
+
+    m_has_picked = true;
+    hide();
+}
+
+
+void gui::FolderPicker::move_selection(int by)
+{
+    m_selected = std::clamp(m_selected + by, 0, row_count() - 1);
+    scroll_to_selected();
+
+    m_dirty = true;
+}
+
+
+void gui::FolderPicker::scroll_to_selected()
+{
+    if (m_selected < m_first)
+        m_first = m_selected;
+    else if (m_selected >= m_first + m_rows)
+        m_first = m_selected - m_rows + 1;
+}
+
+
+SDL_Rect gui::FolderPicker::row_rect(int row) const
+{
+    return {
+        m_rect.x + 1,
+        m_rect.y + FOLDER_PICKER_PADDING + (row + 1) * m_char_dim.y,
+        m_rect.w - 2,
+        m_char_dim.y
+    };
+}
+
+
+SDL_Rect gui::FolderPicker::select_rect() const
+{
+    return {
+        m_rect.x + m_rect.w - FOLDER_PICKER_PADDING - BUTTON_WIDTH,
+        m_rect.y + m_rect.h - FOLDER_PICKER_PADDING - BUTTON_HEIGHT,
+        BUTTON_WIDTH,
+        BUTTON_HEIGHT
+    };
+}
+
+
+SDL_Rect gui::FolderPicker::cancel_rect() const
+{
+    SDL_Rect rect = select_rect();
+    rect.x -= BUTTON_WIDTH + FOLDER_PICKER_PADDING;
+
+    return rect;
+}
+
+
+void gui::FolderPicker::render_button(SDL_Renderer* rend, SDL_Rect rect, const char* text)
+{
+    SDL_SetRenderDrawColor(rend, 100, 100, 100, 255);
+    SDL_RenderFillRect(rend, &rect);
+
+    int text_w = (int)strlen(text) * m_char_dim.x;
+    m_atlas->add_text(text, rect.x + (rect.w - text_w) / 2, rect.y + (rect.h - m_char_dim.y) / 2, { 255, 255, 255, 255 });
+}
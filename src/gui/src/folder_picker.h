@@ -0,0 +1,96 @@
+#pragma once
+#include "common.h"
+#include "glyph_atlas.h"
+#include "texture_cache.h"
+#include "directory_scanner.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <SDL.h>
+
+
+namespace gui
+{
+    /* Box over the editor for picking a folder, driven by the main loop like everything else.
+    * Folders are listed by a DirectoryScanner and show up as they are found, so a slow directory
+    * never stops the editor from drawing. Only the rows that fit in the box are drawn.
+    */
+    class FolderPicker
+    {
+    public:
+        FolderPicker(common::Font& font);
+
+        // starts listing dir and shows the box until a folder is picked or it is cancelled
+        void show(const std::string& dir);
+        void hide();
+        bool shown() const { return m_shown; }
+        bool contains(int mx, int my) const { return m_shown && common::within_rect(m_rect, mx, my); }
+
+        /* A double click on a folder opens it, clicking outside of the box cancels.
+        * clicks is how many times in a row the mouse was clicked, like in SDL_MouseButtonEvent.
+        */
+        void mouse_down(int mx, int my, int clicks);
+        /* Up and down select, enter opens the selected folder or picks the one being shown if none is selected,
+        * backspace goes up a folder and escape cancels.
+        */
+        void key_down(SDL_Keycode key);
+        void scroll(int rows);
+
+        // returns false until a folder has been picked, then hands it out once
+        bool take_picked(std::string& path);
+
+        // picks up whatever was listed since the last call
+        void update();
+
+        // true if something changed since the last render
+        bool dirty() const { return m_dirty; }
+        void render(SDL_Renderer* rend, int window_w, int window_h);
+
+    private:
+        // stops listing the current folder and starts listing dir
+        void open(const std::string& dir);
+        void open_selected();
+        void pick();
+
+        void move_selection(int by);
+        void scroll_to_selected();
+
+        // row 0 is the parent folder, the rest are m_names
+        int row_count() const { return (int)m_names.size() + 1; }
+        SDL_Rect row_rect(int row) const;
+        SDL_Rect select_rect() const;
+        SDL_Rect cancel_rect() const;
+
+        void render_button(SDL_Renderer* rend, SDL_Rect rect, const char* text);
+
+    private:
+        DirectoryScanner m_scanner;
+        size_t m_scan{ 0 };
+
+        std::string m_dir;
+        std::vector<std::string> m_names;
+        bool m_loading{ false };
+
+        // -1 if nothing is selected
+        int m_selected{ -1 };
+        // first row on screen, and how many fit
+        int m_first{ 0 };
+        int m_rows{ 1 };
+
+        std::string m_picked;
+        bool m_has_picked{ false };
+
+        bool m_shown{ false };
+        bool m_dirty{ true };
+
+        // where the box was last drawn
+        SDL_Rect m_rect{ 0, 0, 0, 0 };
+
+        // names are drawn from the atlas, only the ones that arent ascii get textures of their own
+        std::unique_ptr<GlyphAtlas> m_atlas;
+        TextureCache m_name_textures;
+        // non owning, dont free
+        TTF_Font* m_font;
+        SDL_Point m_char_dim;
+    };
+}
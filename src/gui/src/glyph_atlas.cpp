@@ -0,0 +1,118 @@
+#include "glyph_atlas.h"
+#include <algorithm>
+
+// cells per row of the texture, 16 rows of 16 fit every byte value
+#define ATLAS_COLUMNS 16
+
+
+gui::GlyphAtlas::GlyphAtlas(SDL_Renderer* rend, TTF_Font* font, SDL_Point char_dim)
+    : m_rend(rend), m_font(font), m_char_dim(char_dim)
+{
+    m_size = { m_char_dim.x * ATLAS_COLUMNS, m_char_dim.y * (256 / ATLAS_COLUMNS) };
+
+    m_texture = std::unique_ptr<SDL_Texture, common::TextureDeleter>(
+        SDL_CreateTexture(m_rend, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, m_size.x, m_size.y)
+    );
+
+    if (!m_texture)
+        return;
+
+    SDL_SetTextureBlendMode(m_texture.get(), SDL_BLENDMODE_BLEND);
+
+    // cells that never get a glyph have to be transparent
+    std::vector<Uint32> clear(m_size.x * m_size.y, 0);
+    SDL_UpdateTexture(m_texture.get(), nullptr, clear.data(), m_size.x * sizeof(Uint32));
+
+    // printable ascii is nearly all that is ever drawn, the rest is loaded once it shows up
+    for (int c = '!'; c <= '~'; ++c)
+    {
+        load_glyph((unsigned char)c);
+    }
+}
+
+
+void gui::GlyphAtlas::add_text(std::string_view text, int x, int y, SDL_Color color)
+{
+    if (!m_texture)
+        return;
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        unsigned char c = (unsigned char)text[i];
+
+        // spaces and control characters dont draw anything
+        if (c <= ' ')
+            continue;
+
+        if (!m_loaded[c])
+            load_glyph(c);
+
+        SDL_Rect src = cell(c);
+
+        float x1 = (float)(x + (int)i * m_char_dim.x);
+        float y1 = (float)y;
+        float x2 = x1 + m_char_dim.x;
+        float y2 = y1 + m_char_dim.y;
+
+        float u1 = (float)src.x / m_size.x;
+        float v1 = (float)src.y / m_size.y;
+        float u2 = (float)(src.x + src.w) / m_size.x;
+        float v2 = (float)(src.y + src.h) / m_size.y;
+
+        int first = (int)m_vertices.size();
+
+        m_vertices.push_back({ { x1, y1 }, color, { u1, v1 } });
+        m_vertices.push_back({ { x2, y1 }, color, { u2, v1 } });
+        m_vertices.push_back({ { x1, y2 }, color, { u1, v2 } });
+        m_vertices.push_back({ { x2, y2 }, color, { u2, v2 } });
+
+        for (int index : { 0, 1, 2, 2, 1, 3 })
+            m_indices.emplace_back(first + index);
+    }
+}
+
+
+void gui::GlyphAtlas::render()
+{
+    if (!m_vertices.empty())
+        SDL_RenderGeometry(m_rend, m_texture.get(), m_vertices.data(), (int)m_vertices.size(), m_indices.data(), (int)m_indices.size());
+
+    m_vertices.clear();
+    m_indices.clear();
+}
+
+
+void gui::GlyphAtlas::load_glyph(unsigned char c)
+{
+    m_loaded[c] = true;
+
+    // rendered white so the vertex color decides what color it ends up
+    SDL_Surface* glyph = TTF_RenderGlyph_Blended(m_font, c, { 255, 255, 255, 255 });
+
+    if (!glyph)
+        return;
+
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(glyph, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(glyph);
+
+    if (!converted)
+        return;
+
+    SDL_Rect dst = cell(c);
+    dst.w = std::min(dst.w, converted->w);
+    dst.h = std::min(dst.h, converted->h);
+
+    SDL_UpdateTexture(m_texture.get(), &dst, converted->pixels, converted->pitch);
+    SDL_FreeSurface(converted);
+}
+
+
+SDL_Rect gui::GlyphAtlas::cell(unsigned char c) const
+{
+    return {
+        (c % ATLAS_COLUMNS) * m_char_dim.x,
+        (c / ATLAS_COLUMNS) * m_char_dim.y,
+        m_char_dim.x,
+        m_char_dim.y
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "common.h"
+#include <string_view>
+#include <vector>
+#include <array>
+#include <memory>
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+
+namespace gui
+{
+    /* Every glyph of a monospace font rendered once into a single texture, one cell per byte value.
+    * Text is queued as quads pointing into the texture and drawn all at once with SDL_RenderGeometry,
+    * so drawing text never has to rasterize it again or create textures.
+    */
+    class GlyphAtlas
+    {
+    public:
+        GlyphAtlas(SDL_Renderer* rend, TTF_Font* font, SDL_Point char_dim);
+
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        // queues text to be drawn with its top left corner at (x, y)
+        void add_text(std::string_view text, int x, int y, SDL_Color color);
+        // draws everything queued since the last call in one batch
+        void render();
+
+        SDL_Point char_dim() const { return m_char_dim; }
+
+    private:
+        // rasterizes c into its cell, only done the first time c is drawn
+        void load_glyph(unsigned char c);
+        SDL_Rect cell(unsigned char c) const;
+
+    private:
+        // non owning, dont free
+        SDL_Renderer* m_rend;
+        // non owning, dont free
+        TTF_Font* m_font;
+
+        SDL_Point m_char_dim;
+        SDL_Point m_size;
+
+        std::unique_ptr<SDL_Texture, common::TextureDeleter> m_texture;
+        std::array<bool, 256> m_loaded{};
+
+        std::vector<SDL_Vertex> m_vertices;
+        std::vector<int> m_indices;
+    };
+}
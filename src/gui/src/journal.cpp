@@ -0,0 +1,448 @@
+#include "journal.h"
+#include "text.h"
+#include <algorithm>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+
+#define JOURNAL_MAGIC "grassjn2"
+#define JOURNAL_MAGIC_LENGTH 8
+
+// once the log has this many records it is rewritten with neighbouring edits combined
+#define COMPACT_RECORDS 1024
+// the last edit is written once nothing has been typed for this long, in ms
+#define FLUSH_DELAY 1000
+
+namespace fs = std::filesystem;
+
+
+namespace
+{
+    void write_u64(std::ostream& os, uint64_t value)
+    {
+        char bytes[8];
+
+        for (int i = 0; i < 8; ++i)
+            bytes[i] = (char)((value >> (i * 8)) & 0xff);
+
+        os.write(bytes, 8);
+    }
+
+
+    bool read_u64(std::istream& is, uint64_t& value)
+    {
+        unsigned char bytes[8];
+
+        if (!is.read((char*)bytes, 8))
+            return false;
+
+        value = 0;
+
+        for (int i = 0; i < 8; ++i)
+            value |= (uint64_t)bytes[i] << (i * 8);
+
+        return true;
+    }
+
+
+    void write_op(std::ostream& os, const gui::Journal::Op& op)
+    {
+        os.put((char)op.type);
+        write_u64(os, op.offset);
+
+        if (op.type == gui::Journal::Op::Type::INSERT)
+        {
+            write_u64(os, op.text.size());
+            os.write(op.text.data(), op.text.size());
+        }
+        else
+        {
+            write_u64(os, op.length);
+        }
+    }
+
+
+    void write_header(std::ostream& os, size_t base_size, uint64_t base_time)
+    {
+        os.write(JOURNAL_MAGIC, JOURNAL_MAGIC_LENGTH);
+        write_u64(os, base_size);
+        write_u64(os, base_time);
+    }
+
+
+    // last modification time of fp, 0 if it cant be read
+    uint64_t modified_time(const std::string& fp)
+    {
+        std::error_code ec;
+        auto time = fs::last_write_time(fp, ec);
+
+        return ec ? 0 : (uint64_t)time.time_since_epoch().count();
+    }
+}
+
+
+gui::Journal::~Journal()
+{
+    close();
+}
+
+
+void gui::Journal::open(const std::string& fp)
+{
+    close();
+    m_path = fp;
+}
+
+
+void gui::Journal::close()
+{
+    flush();
+    m_file.close();
+
+    m_path.clear();
+    m_ops.clear();
+    m_written = 0;
+    m_records_in_file = 0;
+    m_compacted_records = 0;
+    m_save_pending = false;
+}
+
+
+void gui::Journal::clear()
+{
+    m_file.close();
+
+    if (!m_path.empty())
+    {
+        std::error_code ec;
+        fs::remove(journal_path(m_path), ec);
+    }
+
+    m_ops.clear();
+    m_written = 0;
+    m_records_in_file = 0;
+    m_compacted_records = 0;
+    m_save_pending = false;
+}
+
+
+void gui::Journal::save_started(size_t document_size)
+{
+    if (m_path.empty())
+        return;
+
+    // nothing typed while saving can be merged into an edit that is being saved
+    flush();
+
+    m_save_pending = true;
+    m_save_mark = m_ops.size();
+    m_save_size = document_size;
+}
+
+
+void gui::Journal::save_finished(bool succeeded)
+{
+    if (!m_save_pending)
+        return;
+
+    m_save_pending = false;
+
+    // the old file is still there and every edit is still relative to it
+    if (!succeeded)
+        return;
+
+    if (m_save_mark == m_ops.size())
+    {
+        clear();
+        return;
+    }
+
+    m_ops.erase(m_ops.begin(), m_ops.begin() + m_save_mark);
+    m_base_size = m_save_size;
+    m_base_time = modified_time(m_path);
+
+    rewrite();
+    m_compacted_records = 0;
+}
+
+
+void gui::Journal::record_insert(size_t offset, std::string_view text, size_t document_size)
+{
+    add({ Op::Type::INSERT, offset, 0, std::string(text) }, document_size);
+}
+
+
+void gui::Journal::record_erase(size_t offset, size_t length, size_t document_size)
+{
+    add({ Op::Type::ERASE, offset, length, "" }, document_size);
+}
+
+
+void gui::Journal::update()
+{
+    if (m_written < m_ops.size() && std::chrono::steady_clock::now() - m_last_edit > std::chrono::milliseconds(FLUSH_DELAY))
+        flush();
+}
+
+
+int gui::Journal::ms_until_update() const
+{
+    if (m_written == m_ops.size())
+        return -1;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_last_edit).count();
+    return (int)std::max((long long)0, (long long)FLUSH_DELAY - (long long)elapsed + 1);
+}
+
+
+void gui::Journal::flush()
+{
+    if (m_path.empty() || m_written == m_ops.size())
+        return;
+
+    if (!m_file.is_open())
+    {
+        // a log that was replayed keeps going, otherwise this is the first edit since the last save
+        if (m_records_in_file > 0)
+        {
+            m_file.open(journal_path(m_path), std::ofstream::binary | std::ofstream::app);
+        }
+        else
+        {
+            m_file.open(journal_path(m_path), std::ofstream::binary | std::ofstream::trunc);
+            write_header(m_file, m_base_size, m_base_time);
+        }
+    }
+
+    for (; m_written < m_ops.size(); ++m_written)
+    {
+        write_op(m_file, m_ops[m_written]);
+        ++m_records_in_file;
+    }
+
+    m_file.flush();
+
+    // compacting again right away wont help if most of the edits couldnt be merged last time
+    if (m_records_in_file >= std::max((size_t)COMPACT_RECORDS, m_compacted_records * 2))
+        compact();
+}
+
+
+bool gui::Journal::replay(Text& text)
+{
+    std::vector<Op> ops;
+    size_t base_size;
+    uint64_t base_time;
+
+    if (m_path.empty() || !read(ops, base_size, base_time))
+        return false;
+
+    // the file was changed by something else since the log was started, even if it is still the same size
+    if (base_size != text.size() || base_time != modified_time(m_path))
+    {
+        clear();
+        return false;
+    }
+
+    m_replaying = true;
+
+    for (auto& op : ops)
+    {
+        if (op.type == Op::Type::INSERT)
+            text.insert_at(op.offset, op.text);
+        else
+            text.erase_at(op.offset, op.length);
+    }
+
+    m_replaying = false;
+
+    m_file.close();
+    m_ops = std::move(ops);
+    m_written = m_ops.size();
+    m_records_in_file = m_ops.size();
+    m_compacted_records = 0;
+    m_base_size = base_size;
+    m_base_time = base_time;
+
+    return true;
+}
+
+
+bool gui::Journal::merge(Op& a, const Op& b)
+{
+    if (a.type == Op::Type::INSERT && b.type == Op::Type::INSERT)
+    {
+        // typing more inside of or right after the inserted text
+        if (b.offset < a.offset || b.offset > a.offset + a.text.size())
+            return false;
+
+        a.text.insert(b.offset - a.offset, b.text);
+        return true;
+    }
+
+    if (a.type == Op::Type::INSERT && b.type == Op::Type::ERASE)
+    {
+        // erasing some of the text that was just inserted
+        if (b.offset < a.offset || b.offset + b.length > a.offset + a.text.size())
+            return false;
+
+        a.text.erase(b.offset - a.offset, b.length);
+        return true;
+    }
+
+    if (a.type == Op::Type::ERASE && b.type == Op::Type::ERASE)
+    {
+        // delete
+        if (b.offset == a.offset)
+        {
+            a.length += b.length;
+            return true;
+        }
+
+        // backspace
+        if (b.offset + b.length == a.offset)
+        {
+            a.offset = b.offset;
+            a.length += b.length;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void gui::Journal::add(Op op, size_t document_size)
+{
+    if (m_replaying || m_path.empty())
+        return;
+
+    if (m_ops.empty())
+    {
+        m_base_size = document_size;
+        m_base_time = modified_time(m_path);
+    }
+
+    m_last_edit = std::chrono::steady_clock::now();
+
+    // only the edit that hasnt been written yet can still change
+    if (m_written < m_ops.size() && merge(m_ops.back(), op))
+    {
+        // typing something and erasing it again leaves nothing to record
+        if (m_ops.back().type == Op::Type::INSERT && m_ops.back().text.empty())
+            m_ops.pop_back();
+
+        return;
+    }
+
+    flush();
+    m_ops.emplace_back(std::move(op));
+}
+
+
+void gui::Journal::compact()
+{
+    std::vector<Op> ops;
+    size_t mark = m_save_mark;
+
+    for (size_t i = 0; i < m_ops.size(); ++i)
+    {
+        Op& op = m_ops[i];
+
+        // edits on either side of a save in progress stay apart, the ones before it are dropped once it is done
+        if (m_save_pending && i == m_save_mark)
+        {
+            mark = ops.size();
+        }
+        else if (!ops.empty() && merge(ops.back(), op))
+        {
+            if (ops.back().type == Op::Type::INSERT && ops.back().text.empty())
+                ops.pop_back();
+
+            continue;
+        }
+
+        ops.emplace_back(std::move(op));
+    }
+
+    m_ops = std::move(ops);
+    m_save_mark = mark;
+
+    rewrite();
+    m_compacted_records = m_ops.size();
+}
+
+
+void gui::Journal::rewrite()
+{
+    // written next to the log and renamed over it so a crash never leaves a half written log behind
+    std::string tmp_path = journal_path(m_path) + ".tmp";
+
+    {
+        std::ofstream ofs(tmp_path, std::ofstream::binary | std::ofstream::trunc);
+        write_header(ofs, m_base_size, m_base_time);
+
+        for (auto& op : m_ops)
+            write_op(ofs, op);
+    }
+
+    m_file.close();
+
+    std::error_code ec;
+    fs::rename(tmp_path, journal_path(m_path), ec);
+
+    m_written = m_ops.size();
+    m_records_in_file = m_ops.size();
+}
+
+
+bool gui::Journal::read(std::vector<Op>& ops, size_t& base_size, uint64_t& base_time) const
+{
+    std::ifstream ifs(journal_path(m_path), std::ifstream::binary);
+
+    char magic[JOURNAL_MAGIC_LENGTH];
+    uint64_t base;
+
+    if (!ifs.read(magic, JOURNAL_MAGIC_LENGTH) || memcmp(magic, JOURNAL_MAGIC, JOURNAL_MAGIC_LENGTH) != 0 || !read_u64(ifs, base) || !read_u64(ifs, base_time))
+        return false;
+
+    base_size = (size_t)base;
+
+    std::error_code ec;
+    uint64_t file_size = fs::file_size(journal_path(m_path), ec);
+
+    // a record cut off by a crash ends the log
+    while (true)
+    {
+        char type;
+        uint64_t offset, length;
+
+        if (!ifs.get(type) || !read_u64(ifs, offset) || !read_u64(ifs, length))
+            break;
+
+        Op op{ (Op::Type)type, (size_t)offset, 0, "" };
+
+        if (op.type == Op::Type::INSERT)
+        {
+            if (length > file_size)
+                break;
+
+            op.text.resize(length);
+
+            if (!ifs.read(op.text.data(), length))
+                break;
+        }
+        else if (op.type == Op::Type::ERASE)
+        {
+            op.length = (size_t)length;
+        }
+        else
+        {
+            break;
+        }
+
+        ops.emplace_back(std::move(op));
+    }
+
+    return true;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+
+
+namespace gui
+{
+    class Text;
+
+    /* Append-only log of the edits made to a file since it was last saved, kept in path + "~".
+    * Replaying it onto the file on disk gives back the unsaved buffer, so backing up costs as much as
+    * the edits did instead of as much as the whole file.
+    * Typing is merged into a single edit before it is written, and the log gets rewritten with
+    * everything that can be merged once it has grown to COMPACT_RECORDS records.
+    */
+    class Journal
+    {
+    public:
+        struct Op
+        {
+            enum class Type : char
+            {
+                INSERT = 'i',
+                ERASE = 'e'
+            };
+
+            Type type;
+            size_t offset;
+            // only used by erases
+            size_t length;
+            // only used by inserts
+            std::string text;
+        };
+
+        Journal() = default;
+        ~Journal();
+
+        Journal(const Journal&) = delete;
+        Journal& operator=(const Journal&) = delete;
+
+        // starts recording edits to fp, whatever was being recorded before is written out first
+        void open(const std::string& fp);
+        // writes everything out and stops recording
+        void close();
+        // forgets every edit and deletes the log
+        void clear();
+
+        /* Called when a save of the text as it is now starts, document_size is its size.
+        * The log is kept until the save is done, edits made while saving go after a mark so they survive either way.
+        */
+        void save_started(size_t document_size);
+        /* Called once that save is done. If it succeeded the edits before the mark are dropped and the log
+        * is rewritten relative to the saved file, otherwise it stays relative to the file that is still on disk.
+        */
+        void save_finished(bool succeeded);
+
+        /* Called by Text before every edit.
+        * document_size is the size of the text before the edit, it is stored when a new log is started
+        * so a log that doesnt belong to the file anymore can be detected.
+        */
+        void record_insert(size_t offset, std::string_view text, size_t document_size);
+        void record_erase(size_t offset, size_t length, size_t document_size);
+
+        // writes the last edit if nothing has been typed for a while
+        void update();
+        // ms until update will write the last edit, -1 if there is nothing to write
+        int ms_until_update() const;
+        void flush();
+
+        /* Applies the log of the open file to text, which should contain the file as it is on disk.
+        * Returns false and deletes the log if it doesnt match the text.
+        */
+        bool replay(Text& text);
+
+        static std::string journal_path(const std::string& fp) { return fp + "~"; }
+
+    private:
+        // merges b into a if b continues a, returns false if they have to stay separate
+        static bool merge(Op& a, const Op& b);
+
+        void add(Op op, size_t document_size);
+        void write(const Op& op);
+        void compact();
+        // replaces the log with m_ops, written next to it and renamed over it
+        void rewrite();
+
+        bool read(std::vector<Op>& ops, size_t& base_size, uint64_t& base_time) const;
+
+    private:
+        std::string m_path;
+        std::ofstream m_file;
+
+        // every edit since the last save, m_ops[m_written] and later have not been written yet
+        std::vector<Op> m_ops;
+        size_t m_written{ 0 };
+        size_t m_records_in_file{ 0 };
+        // records left after the last compaction
+        size_t m_compacted_records{ 0 };
+        size_t m_base_size{ 0 };
+        // modification time of the file the log is relative to, so a file changed without changing size is caught too
+        uint64_t m_base_time{ 0 };
+
+        // set between save_started and save_finished, m_ops[m_save_mark] and later were made while saving
+        bool m_save_pending{ false };
+        size_t m_save_mark{ 0 };
+        size_t m_save_size{ 0 };
+
+        std::chrono::steady_clock::time_point m_last_edit;
+
+        // set while replaying so the edits being replayed arent recorded again
+        bool m_replaying{ false };
+    };
+}
@@ -0,0 +1,336 @@
+#include "line_index.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define LINE_INDEX_X86
+#  include <immintrin.h>
+#endif
+
+// lets the simd functions be compiled without enabling avx2 for the whole program, the cpu is checked at runtime instead
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#  define TARGET_SSE2
+#  define TARGET_AVX2
+#else
+#  define TARGET_SSE2 __attribute__((target("sse2")))
+#  define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// splitting up buffers smaller than this per thread costs more than it saves
+#define MIN_BYTES_PER_THREAD (8 * 1024 * 1024)
+
+using gui::line_index::Implementation;
+
+
+namespace
+{
+    int lowest_bit(uint64_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long i;
+
+        if (_BitScanForward(&i, (unsigned long)mask))
+            return (int)i;
+
+        _BitScanForward(&i, (unsigned long)(mask >> 32));
+        return (int)i + 32;
+#else
+        return __builtin_ctzll(mask);
+#endif
+    }
+
+
+    // appends a line start for every bit set in mask, bit i being a new line at data[offset + i]
+    void append_mask(uint64_t mask, size_t offset, std::vector<size_t>& out)
+    {
+        while (mask)
+        {
+            out.emplace_back(offset + lowest_bit(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+
+
+    size_t count_scalar(const char* data, size_t length)
+    {
+        return std::count(data, data + length, '\n');
+    }
+
+
+    void find_scalar(const char* data, size_t length, size_t base, std::vector<size_t>& out)
+    {
+        const char* end = data + length;
+
+        for (const char* p = data; p < end; ++p)
+        {
+            p = (const char*)memchr(p, '\n', end - p);
+
+            if (!p)
+                break;
+
+            out.emplace_back(base + (p - data) + 1);
+        }
+    }
+
+
+#if defined(LINE_INDEX_X86)
+    TARGET_SSE2 size_t count_sse2(const char* data, size_t length)
+    {
+        const __m128i nl = _mm_set1_epi8('\n');
+        const __m128i zero = _mm_setzero_si128();
+
+        size_t total = 0;
+        size_t i = 0;
+
+        while (i + 16 <= length)
+        {
+            // every byte of acc counts matches in its lane, they overflow after 255 rounds
+            __m128i acc = zero;
+            size_t rounds = std::min((length - i) / 16, (size_t)255);
+
+            for (size_t r = 0; r < rounds; ++r, i += 16)
+            {
+                __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+                acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(chunk, nl));
+            }
+
+            __m128i sums = _mm_sad_epu8(acc, zero);
+            total += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums));
+        }
+
+        return total + count_scalar(data + i, length - i);
+    }
+
+
+    TARGET_SSE2 void find_sse2(const char* data, size_t length, size_t base, std::vector<size_t>& out)
+    {
+        const __m128i nl = _mm_set1_epi8('\n');
+        size_t i = 0;
+
+        // 64 bytes at a time so blocks without a new line are skipped with a single check
+        for (; i + 64 <= length; i += 64)
+        {
+            __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), nl);
+            __m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + 16)), nl);
+            __m128i c = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + 32)), nl);
+            __m128i d = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + 48)), nl);
+
+            if (!_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))))
+                continue;
+
+            uint64_t mask = (uint64_t)(uint32_t)_mm_movemask_epi8(a)
+                | (uint64_t)(uint32_t)_mm_movemask_epi8(b) << 16
+                | (uint64_t)(uint32_t)_mm_movemask_epi8(c) << 32
+                | (uint64_t)(uint32_t)_mm_movemask_epi8(d) << 48;
+
+            append_mask(mask, base + i, out);
+        }
+
+        find_scalar(data + i, length - i, base + i, out);
+    }
+
+
+    TARGET_AVX2 size_t count_avx2(const char* data, size_t length)
+    {
+        const __m256i nl = _mm256_set1_epi8('\n');
+        const __m256i zero = _mm256_setzero_si256();
+
+        size_t total = 0;
+        size_t i = 0;
+
+        while (i + 32 <= length)
+        {
+            __m256i acc = zero;
+            size_t rounds = std::min((length - i) / 32, (size_t)255);
+
+            for (size_t r = 0; r < rounds; ++r, i += 32)
+            {
+                __m256i chunk = _mm256_loadu_si256((const __m256i*)(data + i));
+                acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(chunk, nl));
+            }
+
+            alignas(32) uint64_t sums[4];
+            _mm256_store_si256((__m256i*)sums, _mm256_sad_epu8(acc, zero));
+            total += sums[0] + sums[1] + sums[2] + sums[3];
+        }
+
+        return total + count_scalar(data + i, length - i);
+    }
+
+
+    TARGET_AVX2 void find_avx2(const char* data, size_t length, size_t base, std::vector<size_t>& out)
+    {
+        const __m256i nl = _mm256_set1_epi8('\n');
+        size_t i = 0;
+
+        // 128 bytes at a time so long lines are skipped over quickly
+        for (; i + 128 <= length; i += 128)
+        {
+            __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), nl);
+            __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 32)), nl);
+            __m256i c = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 64)), nl);
+            __m256i d = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 96)), nl);
+
+            __m256i any = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+
+            if (_mm256_testz_si256(any, any))
+                continue;
+
+            append_mask((uint64_t)(uint32_t)_mm256_movemask_epi8(a) | (uint64_t)(uint32_t)_mm256_movemask_epi8(b) << 32, base + i, out);
+            append_mask((uint64_t)(uint32_t)_mm256_movemask_epi8(c) | (uint64_t)(uint32_t)_mm256_movemask_epi8(d) << 32, base + i + 64, out);
+        }
+
+        find_scalar(data + i, length - i, base + i, out);
+    }
+#endif /* if defined(LINE_INDEX_X86) */
+
+
+    int thread_count(size_t length)
+    {
+        int max_threads = std::max(1, (int)std::thread::hardware_concurrency());
+        return (int)std::clamp(length / MIN_BYTES_PER_THREAD, (size_t)1, (size_t)max_threads);
+    }
+
+
+    /* Splits [0, length) into one range per thread, every range except the last is a multiple of granularity.
+    * func(thread index, begin, end) is called for every range, the last range runs on the calling thread.
+    */
+    template <typename F>
+    void for_each_range(size_t length, size_t granularity, int threads, F func)
+    {
+        size_t per_thread = (length / threads + granularity - 1) / granularity * granularity;
+
+        std::vector<std::thread> workers;
+
+        for (int t = 0; t < threads - 1; ++t)
+        {
+            size_t begin = std::min(length, t * per_thread);
+            size_t end = std::min(length, begin + per_thread);
+
+            workers.emplace_back(func, t, begin, end);
+        }
+
+        func(threads - 1, std::min(length, (threads - 1) * per_thread), length);
+
+        for (auto& w : workers)
+        {
+            w.join();
+        }
+    }
+}
+
+
+gui::line_index::Implementation gui::line_index::best_implementation()
+{
+    static Implementation impl = []() {
+#if defined(LINE_INDEX_X86)
+        if (SDL_HasAVX2())
+            return Implementation::AVX2;
+
+        if (SDL_HasSSE2())
+            return Implementation::SSE2;
+#endif /* if defined(LINE_INDEX_X86) */
+
+        return Implementation::SCALAR;
+    }();
+
+    return impl;
+}
+
+
+size_t gui::line_index::count_new_lines(const char* data, size_t length)
+{
+    return count_new_lines(data, length, best_implementation());
+}
+
+
+size_t gui::line_index::count_new_lines(const char* data, size_t length, Implementation impl)
+{
+    switch (impl)
+    {
+#if defined(LINE_INDEX_X86)
+    case Implementation::AVX2:
+        return count_avx2(data, length);
+    case Implementation::SSE2:
+        return count_sse2(data, length);
+#endif /* if defined(LINE_INDEX_X86) */
+    default:
+        return count_scalar(data, length);
+    }
+}
+
+
+void gui::line_index::find_line_starts(const char* data, size_t length, size_t base, std::vector<size_t>& out)
+{
+    find_line_starts(data, length, base, out, best_implementation());
+}
+
+
+void gui::line_index::find_line_starts(const char* data, size_t length, size_t base, std::vector<size_t>& out, Implementation impl)
+{
+    switch (impl)
+    {
+#if defined(LINE_INDEX_X86)
+    case Implementation::AVX2:
+        find_avx2(data, length, base, out);
+        break;
+    case Implementation::SSE2:
+        find_sse2(data, length, base, out);
+        break;
+#endif /* if defined(LINE_INDEX_X86) */
+    default:
+        find_scalar(data, length, base, out);
+        break;
+    }
+}
+
+
+void gui::line_index::find_line_starts_parallel(const char* data, size_t length, size_t base, std::vector<size_t>& out)
+{
+    int threads = thread_count(length);
+
+    if (threads == 1)
+    {
+        find_line_starts(data, length, base, out);
+        return;
+    }
+
+    std::vector<std::vector<size_t>> results(threads);
+
+    for_each_range(length, 64, threads, [&](int t, size_t begin, size_t end) {
+        find_line_starts(data + begin, end - begin, base + begin, results[t]);
+    });
+
+    size_t total = out.size();
+
+    for (auto& r : results)
+        total += r.size();
+
+    out.reserve(total);
+
+    for (auto& r : results)
+    {
+        out.insert(out.end(), r.begin(), r.end());
+    }
+}
+
+
+std::vector<size_t> gui::line_index::count_new_lines_in_blocks(const char* data, size_t length, size_t block_size)
+{
+    std::vector<size_t> counts((length + block_size - 1) / block_size);
+
+    auto count_blocks = [&](int, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i += block_size)
+        {
+            counts[i / block_size] = count_new_lines(data + i, std::min(block_size, end - i));
+        }
+    };
+
+    for_each_range(length, block_size, thread_count(length), count_blocks);
+
+    return counts;
+}
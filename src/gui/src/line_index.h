@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+
+/* Finding new lines in big buffers, used whenever a file is loaded.
+* Uses AVX2 or SSE2 when the cpu supports it and splits large buffers between threads.
+*/
+namespace gui::line_index
+{
+    enum class Implementation
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    // the fastest implementation the cpu supports, checked once
+    Implementation best_implementation();
+
+    size_t count_new_lines(const char* data, size_t length);
+    size_t count_new_lines(const char* data, size_t length, Implementation impl);
+
+    /* Appends the offset of the start of every line after the first to out, which is the position after each new line.
+    * base is added to every offset.
+    */
+    void find_line_starts(const char* data, size_t length, size_t base, std::vector<size_t>& out);
+    void find_line_starts(const char* data, size_t length, size_t base, std::vector<size_t>& out, Implementation impl);
+
+    // same as find_line_starts but large buffers are split into chunks that are scanned on separate threads
+    void find_line_starts_parallel(const char* data, size_t length, size_t base, std::vector<size_t>& out);
+
+    // splits data into blocks of block_size bytes and counts the new lines of every block, on separate threads if data is large
+    std::vector<size_t> count_new_lines_in_blocks(const char* data, size_t length, size_t block_size);
+}
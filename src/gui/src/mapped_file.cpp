@@ -0,0 +1,145 @@
+#include "mapped_file.h"
+#include "line_index.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif /* if defined(_WIN32) */
+
+// how far past the requested line to keep indexing, so scrolling down doesnt index one line at a time
+#define INDEX_AHEAD (1 << 20)
+
+
+gui::MappedFile::MappedFile(const std::string& path)
+{
+#if defined(_WIN32)
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        return;
+    }
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_file, &size);
+    m_size = (size_t)size.QuadPart;
+    m_open = true;
+
+    if (m_size == 0)
+        return;
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (m_mapping)
+        m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!m_data)
+    {
+        m_size = 0;
+        m_open = false;
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        return;
+
+    struct stat st;
+
+    if (fstat(fd, &st) == 0)
+    {
+        m_size = (size_t)st.st_size;
+        m_open = true;
+
+        if (m_size > 0)
+        {
+            void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (p == MAP_FAILED)
+            {
+                m_size = 0;
+                m_open = false;
+            }
+            else
+            {
+                m_data = (const char*)p;
+                madvise(p, m_size, MADV_SEQUENTIAL);
+            }
+        }
+    }
+
+    // the mapping stays valid after the file is closed
+    close(fd);
+#endif /* if defined(_WIN32) */
+}
+
+
+gui::MappedFile::~MappedFile()
+{
+#if defined(_WIN32)
+    if (m_data)
+        UnmapViewOfFile(m_data);
+
+    if (m_mapping)
+        CloseHandle(m_mapping);
+
+    if (m_file)
+        CloseHandle(m_file);
+#else
+    if (m_data)
+        munmap((void*)m_data, m_size);
+#endif /* if defined(_WIN32) */
+}
+
+
+gui::MappedText::MappedText(const std::string& path)
+    : m_file(path)
+{
+    m_size = m_file.size();
+
+    // same as reading the lines with std::getline, a trailing new line doesnt start another line
+    if (m_size > 0 && m_file.data()[m_size - 1] == '\n')
+        --m_size;
+}
+
+
+bool gui::MappedText::index_more(size_t budget)
+{
+    size_t end = std::min(m_size, m_indexed + budget);
+
+    line_index::find_line_starts_parallel(m_file.data() + m_indexed, end - m_indexed, m_indexed, m_line_starts);
+    m_indexed = end;
+
+    return fully_indexed();
+}
+
+
+std::string_view gui::MappedText::line(size_t i)
+{
+    index_to_line(i + 1);
+
+    if (i >= m_line_starts.size())
+        return {};
+
+    size_t start = m_line_starts[i];
+    // either the next line has been found or the whole file has been indexed
+    size_t end = i + 1 < m_line_starts.size() ? m_line_starts[i + 1] - 1 : m_size;
+
+    return std::string_view(m_file.data() + start, end - start);
+}
+
+
+void gui::MappedText::index_to_line(size_t i)
+{
+    while (m_line_starts.size() <= i && !fully_indexed())
+    {
+        index_more(INDEX_AHEAD);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+
+namespace gui
+{
+    // read only memory mapping of a whole file
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool is_open() const { return m_open; }
+
+        const char* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        const char* m_data{ nullptr };
+        size_t m_size{ 0 };
+        bool m_open{ false };
+
+#if defined(_WIN32)
+        void* m_file{ nullptr };
+        void* m_mapping{ nullptr };
+#endif /* if defined(_WIN32) */
+    };
+
+    /* Read only document backed by a MappedFile. Nothing is read up front, lines are found
+    * the first time something past what has been indexed so far is asked for.
+    */
+    class MappedText
+    {
+    public:
+        explicit MappedText(const std::string& path);
+
+        bool is_open() const { return m_file.is_open(); }
+
+        /* Scans at most budget more bytes for new lines.
+        * Returns true once the whole file has been indexed.
+        */
+        bool index_more(size_t budget);
+        bool fully_indexed() const { return m_indexed >= m_size; }
+
+        // lines found so far, only the real amount once fully indexed
+        size_t line_count() const { return m_line_starts.size(); }
+
+        std::string_view line(size_t i);
+        size_t line_length(size_t i) { return line(i).size(); }
+
+        // index until line i has been found or the end of the file is reached
+        void index_to_line(size_t i);
+
+        // the text without a trailing new line, same as what gui::Text would hold
+        std::string_view str() const { return std::string_view(m_file.data(), m_size); }
+        const char* data() const { return m_file.data(); }
+
+    private:
+        MappedFile m_file;
+        size_t m_size{ 0 };
+
+        // offset of the start of every line found so far
+        std::vector<size_t> m_line_starts{ 0 };
+        // how many bytes have been scanned
+        size_t m_indexed{ 0 };
+    };
+}
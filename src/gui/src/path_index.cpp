@@ -0,0 +1,509 @@
+#include "path_index.h"
+#include "common.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#  define PATH_SLASH '\\'
+#else
+#  define PATH_SLASH '/'
+#endif /* if defined(_WIN32) */
+
+// paths each thread takes at a time while searching
+#define SEARCH_CHUNK 4096
+#define MAX_SEARCH_THREADS 8
+// folders nested deeper than this arent listed, symlinks can make a folder contain itself
+#define MAX_DEPTH 32
+// the best results handed out for each query
+#define MAX_RESULTS 100
+
+// what each matched character is worth, and what makes it worth more
+#define MATCH_SCORE 16
+#define WORD_START_BONUS 12
+#define CAMEL_CASE_BONUS 8
+#define CONSECUTIVE_BONUS 10
+#define NAME_BONUS 6
+#define GAP_PENALTY 1
+
+
+namespace
+{
+    char lower(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+    }
+
+
+    bool separator(char c)
+    {
+        return c == '/' || c == '\\' || c == '_' || c == '-' || c == '.' || c == ' ';
+    }
+
+
+    // a bit for every letter and digit, everything else shares the rest
+    uint64_t char_bit(char c)
+    {
+        c = lower(c);
+
+        if (c >= 'a' && c <= 'z')
+            return 1ull << (c - 'a');
+
+        if (c >= '0' && c <= '9')
+            return 1ull << (26 + c - '0');
+
+        return 1ull << (36 + (unsigned char)c % 28);
+    }
+}
+
+
+gui::PathIndex::PathIndex()
+{
+    m_offsets.push_back(0);
+
+    int threads = std::clamp((int)std::thread::hardware_concurrency(), 1, MAX_SEARCH_THREADS);
+
+    // the search thread is one of them
+    m_worker_matches.resize(threads);
+
+    for (int i = 1; i < threads; ++i)
+        m_pool.emplace_back(&PathIndex::work_pool, this, i);
+
+    m_thread = std::thread(&PathIndex::work, this);
+}
+
+
+gui::PathIndex::~PathIndex()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+
+    m_wake.notify_all();
+    m_thread.join();
+
+    {
+        std::lock_guard<std::mutex> lock(m_pool_mutex);
+        m_pool_quit = true;
+    }
+
+    m_pool_wake.notify_all();
+
+    for (auto& t : m_pool)
+        t.join();
+}
+
+
+void gui::PathIndex::build(const std::string& root)
+{
+    for (auto& [id, folder] : m_scans)
+        m_scanner.cancel(id);
+
+    m_scans.clear();
+
+    m_root = root;
+    m_scans[m_scanner.scan(root)] = "";
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_staged.clear();
+        m_reset = true;
+
+        // whatever is being searched for right now is searched for again in the new index
+        ++m_query_version;
+    }
+
+    m_wake.notify_one();
+}
+
+
+void gui::PathIndex::update()
+{
+    std::vector<std::string> found;
+
+    for (auto& batch : m_scanner.take())
+    {
+        auto it = m_scans.find(batch.id);
+
+        if (it == m_scans.end())
+            continue;
+
+        // scanning more folders can move it around
+        std::string folder = it->second;
+        int depth = (int)std::count(folder.begin(), folder.end(), PATH_SLASH);
+
+        if (batch.done)
+            m_scans.erase(it);
+
+        for (auto& entry : batch.entries)
+        {
+            if (!entry.directory)
+            {
+                found.emplace_back(folder + entry.name);
+                continue;
+            }
+
+            // .git and friends would be most of the paths without anyone ever wanting to open them
+            if (entry.name[0] == '.' || depth >= MAX_DEPTH)
+                continue;
+
+            m_scans[m_scanner.scan(m_root + PATH_SLASH + folder + entry.name)] = folder + entry.name + PATH_SLASH;
+        }
+    }
+
+    if (found.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_staged.empty())
+            m_staged = std::move(found);
+        else
+            m_staged.insert(m_staged.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+    }
+
+    m_wake.notify_one();
+}
+
+
+void gui::PathIndex::search(const std::string& query)
+{
+    std::string lowered = query;
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), lower);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (lowered == m_query)
+            return;
+
+        m_query = lowered;
+        ++m_query_version;
+    }
+
+    m_wake.notify_one();
+}
+
+
+bool gui::PathIndex::take_results(Results& results)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_new_results)
+        return false;
+
+    results = std::move(m_results);
+    m_new_results = false;
+
+    return true;
+}
+
+
+uint64_t gui::PathIndex::char_mask(std::string_view s)
+{
+    uint64_t mask = 0;
+
+    for (char c : s)
+        mask |= char_bit(c);
+
+    return mask;
+}
+
+
+int gui::PathIndex::score(std::string_view path, std::string_view query)
+{
+    if (query.size() > path.size())
+        return -1;
+
+    if (query.empty())
+        return 0;
+
+    // the first place every character shows up in order
+    size_t q = 0;
+    size_t end = 0;
+
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        if (lower(path[i]) == query[q] && ++q == query.size())
+        {
+            end = i;
+            break;
+        }
+    }
+
+    if (q < query.size())
+        return -1;
+
+    // going back from there finds the shortest stretch that still has all of them
+    size_t start = end;
+
+    for (size_t i = end + 1; i-- > 0;)
+    {
+        if (lower(path[i]) == query[q - 1] && --q == 0)
+        {
+            start = i;
+            break;
+        }
+    }
+
+    size_t name_start = path.size();
+
+    while (name_start > 0 && path[name_start - 1] != '/' && path[name_start - 1] != '\\')
+        --name_start;
+
+    int total = 0;
+    int run = 0;
+    q = 0;
+
+    for (size_t i = start; i <= end && q < query.size(); ++i)
+    {
+        char c = path[i];
+
+        if (lower(c) != query[q])
+        {
+            run = 0;
+            total -= GAP_PENALTY;
+            continue;
+        }
+
+        int s = MATCH_SCORE;
+
+        if (i == 0 || separator(path[i - 1]))
+            s += WORD_START_BONUS;
+        else if (path[i - 1] >= 'a' && path[i - 1] <= 'z' && c >= 'A' && c <= 'Z')
+            s += CAMEL_CASE_BONUS;
+
+        if (run > 0)
+            s += CONSECUTIVE_BONUS;
+
+        if (i >= name_start)
+            s += NAME_BONUS;
+
+        total += s;
+        ++run;
+        ++q;
+    }
+
+    return total;
+}
+
+
+void gui::PathIndex::work()
+{
+    // the query the current results are for
+    uint64_t searched_version = 0;
+
+    while (true)
+    {
+        std::string query;
+        uint64_t version;
+        std::vector<std::string> staged;
+        bool reset;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]() { return m_quit || m_reset || !m_staged.empty() || m_query_version != searched_version; });
+
+            if (m_quit)
+                return;
+
+            staged.swap(m_staged);
+            reset = m_reset;
+            m_reset = false;
+
+            query = m_query;
+            version = m_query_version;
+        }
+
+        if (reset)
+        {
+            m_chars.clear();
+            m_offsets.assign(1, 0);
+            m_masks.clear();
+
+            m_last_query.clear();
+            m_matches.clear();
+            m_searched = 0;
+        }
+
+        for (auto& p : staged)
+        {
+            m_chars += p;
+            m_offsets.push_back(m_chars.size());
+            m_masks.push_back(char_mask(p));
+        }
+
+        // typed again in the middle of it, the next time around searches for that instead
+        if (!run_search(query, version))
+            continue;
+
+        searched_version = version;
+        publish(query);
+    }
+}
+
+
+void gui::PathIndex::work_pool(int worker)
+{
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_pool_mutex);
+            m_pool_wake.wait(lock, [&]() { return m_pool_quit || m_job_generation != generation; });
+
+            if (m_pool_quit)
+                return;
+
+            generation = m_job_generation;
+        }
+
+        run_chunks(worker);
+
+        std::lock_guard<std::mutex> lock(m_pool_mutex);
+
+        if (--m_workers_busy == 0)
+            m_pool_done.notify_one();
+    }
+}
+
+
+void gui::PathIndex::parallel_for(size_t count, const std::function<void(size_t first, size_t last, int worker)>& fn)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_pool_mutex);
+
+        m_job = &fn;
+        m_job_count = count;
+        m_next_chunk = 0;
+        m_workers_busy = (int)m_pool.size();
+        ++m_job_generation;
+    }
+
+    m_pool_wake.notify_all();
+
+    run_chunks(0);
+
+    std::unique_lock<std::mutex> lock(m_pool_mutex);
+    m_pool_done.wait(lock, [this]() { return m_workers_busy == 0; });
+
+    m_job = nullptr;
+}
+
+
+void gui::PathIndex::run_chunks(int worker)
+{
+    while (true)
+    {
+        size_t first = m_next_chunk++ * SEARCH_CHUNK;
+
+        if (first >= m_job_count)
+            return;
+
+        (*m_job)(first, std::min(m_job_count, first + SEARCH_CHUNK), worker);
+    }
+}
+
+
+bool gui::PathIndex::run_search(const std::string& query, uint64_t version)
+{
+    size_t size = m_offsets.size() - 1;
+
+    if (query.empty())
+    {
+        m_last_query.clear();
+        m_matches.clear();
+        m_searched = size;
+
+        return true;
+    }
+
+    // only new paths have to be looked at for the same query, and a longer query can only match what the shorter one did
+    bool same = query == m_last_query;
+    bool narrowing = !same && !m_last_query.empty() && query.compare(0, m_last_query.size(), m_last_query) == 0;
+
+    size_t old_count = narrowing ? m_matches.size() : 0;
+    size_t first_new = same || narrowing ? m_searched : 0;
+    size_t count = old_count + (size - first_new);
+
+    for (auto& matches : m_worker_matches)
+        matches.clear();
+
+    uint64_t query_mask = char_mask(query);
+
+    parallel_for(count, [&](size_t first, size_t last, int worker) {
+        // the query changed, nothing found from here on will be used
+        if (m_query_version != version)
+            return;
+
+        auto& matches = m_worker_matches[worker];
+
+        for (size_t i = first; i < last; ++i)
+        {
+            uint32_t index = (uint32_t)(i < old_count ? m_matches[i].index : first_new + (i - old_count));
+
+            // most paths dont have every character of the query in them at all, they are skipped without being looked at
+            if ((m_masks[index] & query_mask) != query_mask)
+                continue;
+
+            int s = score(path(index), query);
+
+            if (s >= 0)
+                matches.push_back({ index, s });
+        }
+    });
+
+    if (m_query_version != version)
+        return false;
+
+    if (!same)
+        m_matches.clear();
+
+    for (auto& matches : m_worker_matches)
+        m_matches.insert(m_matches.end(), matches.begin(), matches.end());
+
+    m_last_query = query;
+    m_searched = size;
+
+    return true;
+}
+
+
+void gui::PathIndex::publish(const std::string& query)
+{
+    Results results;
+    results.query = query;
+    results.matched = m_matches.size();
+    results.total = m_offsets.size() - 1;
+
+    std::vector<Match> best(m_matches);
+    size_t count = std::min(best.size(), (size_t)MAX_RESULTS);
+
+    // shorter paths go first when the score is the same, they are usually what was meant
+    std::partial_sort(best.begin(), best.begin() + count, best.end(), [this](const Match& a, const Match& b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+
+        size_t a_size = m_offsets[a.index + 1] - m_offsets[a.index];
+        size_t b_size = m_offsets[b.index + 1] - m_offsets[b.index];
+
+        if (a_size != b_size)
+            return a_size < b_size;
+
+        return a.index < b.index;
+    });
+
+    for (size_t i = 0; i < count; ++i)
+        results.paths.emplace_back(path(best[i].index));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_results = std::move(results);
+        m_new_results = true;
+    }
+
+    common::wake_main_loop();
+}
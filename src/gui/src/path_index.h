@@ -0,0 +1,146 @@
+#pragma once
+#include "directory_scanner.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+
+namespace gui
+{
+    /* Every file under a folder, listed in the background with a DirectoryScanner, and fuzzy searched by query.
+    * Searching runs on its own thread and splits the paths up between a pool of threads, so a query never
+    * blocks the main loop. A query that only adds characters to the end of the last one is searched for
+    * in whatever matched last time instead of in every path, which is how typing a query goes.
+    */
+    class PathIndex
+    {
+    public:
+        struct Results
+        {
+            // the query these are for
+            std::string query;
+            // relative to the root, best match first
+            std::vector<std::string> paths;
+
+            // how many paths matched, and how many there were to match against
+            size_t matched{ 0 };
+            size_t total{ 0 };
+        };
+
+        PathIndex();
+        ~PathIndex();
+
+        PathIndex(const PathIndex&) = delete;
+        PathIndex& operator=(const PathIndex&) = delete;
+
+        // forgets everything and starts listing everything under root
+        void build(const std::string& root);
+        // hands whatever the scanner found to the search thread, call every frame
+        void update();
+
+        // results for query show up in take_results once they are ready
+        void search(const std::string& query);
+        // returns false if nothing new was found since the last call
+        bool take_results(Results& results);
+
+        const std::string& root() const { return m_root; }
+        // folders are still being listed
+        bool building() const { return !m_scans.empty(); }
+
+        /* How well query matches path, -1 if it doesnt match at all. query has to be lowercase.
+        * Every character of query has to show up in path in order, matches at the start of a word
+        * and runs of consecutive characters score higher, and so do matches in the file name.
+        */
+        static int score(std::string_view path, std::string_view query);
+        // which characters show up in s, in either case
+        static uint64_t char_mask(std::string_view s);
+
+    private:
+        struct Match
+        {
+            uint32_t index;
+            int score;
+        };
+
+        // the search thread
+        void work();
+        void work_pool(int worker);
+
+        /* Runs fn over [0, count) split into chunks, on the pool and the calling thread.
+        * fn gets the range of a chunk and which thread it is running on, 0 is the calling thread.
+        */
+        void parallel_for(size_t count, const std::function<void(size_t first, size_t last, int worker)>& fn);
+        // takes chunks of the current job until there are none left
+        void run_chunks(int worker);
+
+        // returns false and leaves m_matches alone if the query changed in the middle of it
+        bool run_search(const std::string& query, uint64_t version);
+        void publish(const std::string& query);
+
+        std::string_view path(uint32_t i) const { return std::string_view(m_chars.data() + m_offsets[i], m_offsets[i + 1] - m_offsets[i]); }
+
+    private:
+        /* Main thread */
+
+        std::string m_root;
+        DirectoryScanner m_scanner;
+        // folder each scan is listing, relative to the root and ending in a slash
+        std::unordered_map<size_t, std::string> m_scans;
+
+        /* Search thread, nothing else touches these */
+
+        std::thread m_thread;
+
+        // every path, one after another, path i goes from m_offsets[i] to m_offsets[i + 1]
+        std::string m_chars;
+        std::vector<size_t> m_offsets;
+        // char_mask of every path
+        std::vector<uint64_t> m_masks;
+
+        // what the last finished search was for, and everything it matched
+        std::string m_last_query;
+        std::vector<Match> m_matches;
+        // paths from here on were added after the last search and havent been looked at
+        size_t m_searched{ 0 };
+
+        /* Pool */
+
+        std::vector<std::thread> m_pool;
+        const std::function<void(size_t, size_t, int)>* m_job{ nullptr };
+        size_t m_job_count{ 0 };
+        std::atomic<size_t> m_next_chunk{ 0 };
+        uint64_t m_job_generation{ 0 };
+        int m_workers_busy{ 0 };
+        std::mutex m_pool_mutex;
+        std::condition_variable m_pool_wake;
+        std::condition_variable m_pool_done;
+        bool m_pool_quit{ false };
+        // results of each thread in the middle of a search
+        std::vector<std::vector<Match>> m_worker_matches;
+
+        /* Shared, guarded by m_mutex */
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+
+        std::string m_query;
+        // changes whenever the query does, so a search in progress can tell it is out of date
+        std::atomic<uint64_t> m_query_version{ 0 };
+        // paths waiting to be added to the index
+        std::vector<std::string> m_staged;
+        // set to start over with an empty index
+        bool m_reset{ false };
+
+        Results m_results;
+        bool m_new_results{ false };
+
+        bool m_quit{ false };
+    };
+}
@@ -0,0 +1,477 @@
+#include "piece_table.h"
+#include "line_index.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <random>
+
+// new blocks of the add buffer are at least this big so typing doesnt allocate on every character
+#define ADD_BLOCK_SIZE 65536
+
+
+namespace
+{
+    size_t count_line_feeds(const char* data, size_t length)
+    {
+        return gui::line_index::count_new_lines(data, length);
+    }
+}
+
+
+gui::PieceTable::PieceTable(std::string_view text)
+{
+    if (text.empty())
+        return;
+
+    std::shared_ptr<char[]> original(new char[text.size()]);
+    memcpy(original.get(), text.data(), text.size());
+
+    *this = PieceTable(std::shared_ptr<const char>(original, original.get()), text.size());
+}
+
+
+gui::PieceTable::PieceTable(std::shared_ptr<const char> buffer, size_t length)
+{
+    if (length == 0)
+        return;
+
+    // counting is what takes the time on big files, so it happens for all pieces at once across threads
+    std::vector<size_t> line_feeds = line_index::count_new_lines_in_blocks(buffer.get(), length, max_piece_length);
+
+    std::vector<Piece> pieces(line_feeds.size());
+
+    for (size_t i = 0; i < pieces.size(); ++i)
+    {
+        size_t start = i * max_piece_length;
+
+        pieces[i].data = std::shared_ptr<const char>(buffer, buffer.get() + start);
+        pieces[i].length = std::min(max_piece_length, length - start);
+        pieces[i].line_feeds = line_feeds[i];
+    }
+
+    m_root = build(pieces);
+}
+
+
+gui::PieceTable::PieceTable(const PieceTable& other)
+    : m_root(other.m_root) {}
+
+
+gui::PieceTable& gui::PieceTable::operator=(const PieceTable& other)
+{
+    m_root = other.m_root;
+
+    m_add = nullptr;
+    m_add_used = 0;
+    m_add_capacity = 0;
+
+    return *this;
+}
+
+
+void gui::PieceTable::insert(size_t offset, std::string_view text)
+{
+    if (text.empty())
+        return;
+
+    offset = std::min(offset, size());
+
+    auto [left, right] = split(m_root, offset);
+
+    // typing appends to the add buffer right after the previous character, so the last piece can just grow
+    const Piece* last = last_piece(left);
+
+    if (last && m_add && last->data.get() + last->length == m_add.get() + m_add_used
+        && last->length + text.size() <= max_piece_length && m_add_used + text.size() <= m_add_capacity)
+    {
+        memcpy(m_add.get() + m_add_used, text.data(), text.size());
+        m_add_used += text.size();
+
+        left = replace_last(left, make_piece(last->data, last->length + text.size()));
+        m_root = merge(left, right);
+        return;
+    }
+
+    m_root = merge(merge(left, build(append_to_add_buffer(text))), right);
+}
+
+
+void gui::PieceTable::erase(size_t offset, size_t length)
+{
+    if (length == 0 || offset >= size())
+        return;
+
+    auto [left, rest] = split(m_root, offset);
+    auto [removed, right] = split(rest, length);
+
+    m_root = merge(left, right);
+}
+
+
+size_t gui::PieceTable::line_offset(size_t line) const
+{
+    if (line == 0 || !m_root)
+        return 0;
+
+    if (line > m_root->line_feeds)
+        return size();
+
+    const Node* node = m_root.get();
+    size_t offset = 0;
+
+    // the line starts right after the line-th new line
+    while (node)
+    {
+        size_t left_feeds = node->left ? node->left->line_feeds : 0;
+        size_t left_length = node->left ? node->left->length : 0;
+
+        if (line <= left_feeds)
+        {
+            node = node->left.get();
+            continue;
+        }
+
+        line -= left_feeds;
+        offset += left_length;
+
+        if (line <= node->piece.line_feeds)
+        {
+            const char* data = node->piece.data.get();
+            const char* end = data + node->piece.length;
+
+            for (const char* p = data; p < end; ++p)
+            {
+                p = (const char*)memchr(p, '\n', end - p);
+
+                if (--line == 0)
+                    return offset + (p - data) + 1;
+            }
+        }
+
+        line -= node->piece.line_feeds;
+        offset += node->piece.length;
+        node = node->right.get();
+    }
+
+    return size();
+}
+
+
+size_t gui::PieceTable::line_length(size_t line) const
+{
+    if (line >= line_count())
+        return 0;
+
+    size_t start = line_offset(line);
+
+    if (line + 1 == line_count())
+        return size() - start;
+
+    return line_offset(line + 1) - 1 - start;
+}
+
+
+size_t gui::PieceTable::line_count() const
+{
+    return (m_root ? m_root->line_feeds : 0) + 1;
+}
+
+
+size_t gui::PieceTable::size() const
+{
+    return m_root ? m_root->length : 0;
+}
+
+
+void gui::PieceTable::copy(size_t offset, size_t length, std::string& out) const
+{
+    if (offset >= size())
+        return;
+
+    length = std::min(length, size() - offset);
+    out.reserve(out.size() + length);
+
+    // offset and end are relative to the start of the subtree
+    std::function<void(const Node*, size_t, size_t)> copy_range = [&](const Node* node, size_t offset, size_t end) {
+        if (!node || offset >= end)
+            return;
+
+        size_t piece_start = node->left ? node->left->length : 0;
+        size_t piece_end = piece_start + node->piece.length;
+
+        if (offset < piece_start)
+            copy_range(node->left.get(), offset, std::min(end, piece_start));
+
+        size_t from = std::max(offset, piece_start);
+        size_t to = std::min(end, piece_end);
+
+        if (from < to)
+            out.append(node->piece.data.get() + (from - piece_start), to - from);
+
+        if (end > piece_end)
+            copy_range(node->right.get(), std::max(offset, piece_end) - piece_end, end - piece_end);
+    };
+
+    copy_range(m_root.get(), offset, offset + length);
+}
+
+
+std::string_view gui::PieceTable::view(size_t offset, size_t length, std::string& buffer) const
+{
+    if (offset >= size() || length == 0)
+        return {};
+
+    length = std::min(length, size() - offset);
+
+    const Node* node = m_root.get();
+    size_t start = offset;
+
+    while (node)
+    {
+        size_t left_length = node->left ? node->left->length : 0;
+
+        if (start < left_length)
+        {
+            node = node->left.get();
+        }
+        else if (start < left_length + node->piece.length)
+        {
+            start -= left_length;
+
+            if (start + length <= node->piece.length)
+                return std::string_view(node->piece.data.get() + start, length);
+
+            break;
+        }
+        else
+        {
+            start -= left_length + node->piece.length;
+            node = node->right.get();
+        }
+    }
+
+    buffer.clear();
+    copy(offset, length, buffer);
+
+    return buffer;
+}
+
+
+std::string gui::PieceTable::str() const
+{
+    std::string s;
+    copy(0, size(), s);
+
+    return s;
+}
+
+
+std::vector<std::string_view> gui::PieceTable::pieces() const
+{
+    std::vector<std::string_view> out;
+    std::vector<const Node*> stack;
+    const Node* node = m_root.get();
+
+    while (node || !stack.empty())
+    {
+        while (node)
+        {
+            stack.emplace_back(node);
+            node = node->left.get();
+        }
+
+        node = stack.back();
+        stack.pop_back();
+
+        out.emplace_back(node->piece.data.get(), node->piece.length);
+        node = node->right.get();
+    }
+
+    return out;
+}
+
+
+gui::PieceTable::NodePtr gui::PieceTable::make_node(const NodePtr& left, const Piece& piece, uint32_t priority, const NodePtr& right)
+{
+    auto node = std::make_shared<Node>();
+
+    node->left = left;
+    node->right = right;
+    node->piece = piece;
+    node->priority = priority;
+
+    node->length = piece.length + (left ? left->length : 0) + (right ? right->length : 0);
+    node->line_feeds = piece.line_feeds + (left ? left->line_feeds : 0) + (right ? right->line_feeds : 0);
+
+    return node;
+}
+
+
+std::pair<gui::PieceTable::NodePtr, gui::PieceTable::NodePtr> gui::PieceTable::split(const NodePtr& node, size_t offset)
+{
+    if (!node)
+        return { nullptr, nullptr };
+
+    size_t left_length = node->left ? node->left->length : 0;
+
+    if (offset <= left_length)
+    {
+        auto [a, b] = split(node->left, offset);
+        return { a, make_node(b, node->piece, node->priority, node->right) };
+    }
+
+    if (offset >= left_length + node->piece.length)
+    {
+        auto [a, b] = split(node->right, offset - left_length - node->piece.length);
+        return { make_node(node->left, node->piece, node->priority, a), b };
+    }
+
+    // the split point is inside of this piece
+    auto [first, second] = split_piece(node->piece, offset - left_length);
+
+    return {
+        make_node(node->left, first, node->priority, nullptr),
+        make_node(nullptr, second, node->priority, node->right)
+    };
+}
+
+
+gui::PieceTable::NodePtr gui::PieceTable::merge(const NodePtr& a, const NodePtr& b)
+{
+    if (!a)
+        return b;
+
+    if (!b)
+        return a;
+
+    if (a->priority > b->priority)
+        return make_node(a->left, a->piece, a->priority, merge(a->right, b));
+    else
+        return make_node(merge(a, b->left), b->piece, b->priority, b->right);
+}
+
+
+gui::PieceTable::NodePtr gui::PieceTable::build(const std::vector<Piece>& pieces)
+{
+    if (pieces.empty())
+        return nullptr;
+
+    // hand out random priorities from highest to lowest in breadth first order so the balanced tree is also a valid treap
+    std::vector<uint32_t> sorted(pieces.size());
+    std::generate(sorted.begin(), sorted.end(), random_priority);
+    std::sort(sorted.begin(), sorted.end(), std::greater<uint32_t>());
+
+    std::vector<uint32_t> priorities(pieces.size());
+    std::deque<std::pair<size_t, size_t>> ranges = { { 0, pieces.size() } };
+    size_t next = 0;
+
+    while (!ranges.empty())
+    {
+        auto [lo, hi] = ranges.front();
+        ranges.pop_front();
+
+        if (lo >= hi)
+            continue;
+
+        size_t mid = (lo + hi) / 2;
+        priorities[mid] = sorted[next++];
+
+        ranges.emplace_back(lo, mid);
+        ranges.emplace_back(mid + 1, hi);
+    }
+
+    std::function<NodePtr(size_t, size_t)> build_range = [&](size_t lo, size_t hi) -> NodePtr {
+        if (lo >= hi)
+            return nullptr;
+
+        size_t mid = (lo + hi) / 2;
+        return make_node(build_range(lo, mid), pieces[mid], priorities[mid], build_range(mid + 1, hi));
+    };
+
+    return build_range(0, pieces.size());
+}
+
+
+gui::PieceTable::NodePtr gui::PieceTable::replace_last(const NodePtr& node, const Piece& piece)
+{
+    if (!node->right)
+        return make_node(node->left, piece, node->priority, nullptr);
+
+    return make_node(node->left, node->piece, node->priority, replace_last(node->right, piece));
+}
+
+
+const gui::PieceTable::Piece* gui::PieceTable::last_piece(const NodePtr& node)
+{
+    if (!node)
+        return nullptr;
+
+    const Node* n = node.get();
+
+    while (n->right)
+        n = n->right.get();
+
+    return &n->piece;
+}
+
+
+gui::PieceTable::Piece gui::PieceTable::make_piece(std::shared_ptr<const char> data, size_t length)
+{
+    Piece piece;
+    piece.line_feeds = count_line_feeds(data.get(), length);
+    piece.data = std::move(data);
+    piece.length = length;
+
+    return piece;
+}
+
+
+std::pair<gui::PieceTable::Piece, gui::PieceTable::Piece> gui::PieceTable::split_piece(const Piece& piece, size_t offset)
+{
+    Piece first = make_piece(piece.data, offset);
+
+    Piece second;
+    second.data = std::shared_ptr<const char>(piece.data, piece.data.get() + offset);
+    second.length = piece.length - offset;
+    second.line_feeds = piece.line_feeds - first.line_feeds;
+
+    return { first, second };
+}
+
+
+uint32_t gui::PieceTable::random_priority()
+{
+    static thread_local std::minstd_rand rng(std::random_device{}());
+    return (uint32_t)rng();
+}
+
+
+std::vector<gui::PieceTable::Piece> gui::PieceTable::append_to_add_buffer(std::string_view text)
+{
+    if (m_add_used + text.size() > m_add_capacity)
+    {
+        // old blocks stay alive for as long as a piece points into them
+        m_add_capacity = std::max((size_t)ADD_BLOCK_SIZE, text.size());
+        m_add = std::shared_ptr<char[]>(new char[m_add_capacity]);
+        m_add_used = 0;
+    }
+
+    char* start = m_add.get() + m_add_used;
+    memcpy(start, text.data(), text.size());
+    m_add_used += text.size();
+
+    // a file being loaded is appended in big chunks, those are counted across threads same as a whole file
+    std::vector<size_t> line_feeds = line_index::count_new_lines_in_blocks(start, text.size(), max_piece_length);
+
+    std::vector<Piece> pieces(line_feeds.size());
+
+    for (size_t i = 0; i < pieces.size(); ++i)
+    {
+        pieces[i].data = std::shared_ptr<const char>(m_add, start + i * max_piece_length);
+        pieces[i].length = std::min(max_piece_length, text.size() - i * max_piece_length);
+        pieces[i].line_feeds = line_feeds[i];
+    }
+
+    return pieces;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+
+namespace gui
+{
+    /* Stores a document as a sequence of pieces pointing into immutable buffers, the original text
+    * and an append-only add buffer. The pieces live in a balanced tree (treap) where every node knows
+    * the length and the amount of new lines in its subtree, so edits and line lookups are O(log n).
+    * Nodes are never modified once created, so copying a PieceTable only copies the root.
+    */
+    class PieceTable
+    {
+    public:
+        PieceTable() = default;
+        explicit PieceTable(std::string_view text);
+        // uses buffer as the original buffer without copying it, buffer must never change
+        PieceTable(std::shared_ptr<const char> buffer, size_t length);
+
+        // copies share every node but never the add buffer, appending to it would overwrite the other table's text
+        PieceTable(const PieceTable& other);
+        PieceTable& operator=(const PieceTable& other);
+
+        PieceTable(PieceTable&&) = default;
+        PieceTable& operator=(PieceTable&&) = default;
+
+        void insert(size_t offset, std::string_view text);
+        void erase(size_t offset, size_t length);
+
+        // offset of the first character of a line, lines are separated by '\n'
+        size_t line_offset(size_t line) const;
+        // length of a line not including the new line
+        size_t line_length(size_t line) const;
+        size_t line_count() const;
+
+        size_t size() const;
+        bool empty() const { return size() == 0; }
+
+        // appends length characters starting at offset to out
+        void copy(size_t offset, size_t length, std::string& out) const;
+
+        /* Returns a view of length characters starting at offset. When they are all inside of one piece the view
+        * points straight into the buffer, otherwise they are copied into buffer first.
+        */
+        std::string_view view(size_t offset, size_t length, std::string& buffer) const;
+        std::string str() const;
+
+        // every piece in order, the views stay valid for as long as this table or a copy of it is alive
+        std::vector<std::string_view> pieces() const;
+
+    public:
+        // pieces are capped at this length so scanning a single piece for a new line stays cheap
+        static constexpr size_t max_piece_length = 4096;
+
+    private:
+        struct Piece
+        {
+            // points at the first character, keeps the buffer it lives in alive
+            std::shared_ptr<const char> data;
+            size_t length{ 0 };
+            size_t line_feeds{ 0 };
+        };
+
+        struct Node;
+        using NodePtr = std::shared_ptr<const Node>;
+
+        struct Node
+        {
+            NodePtr left, right;
+            Piece piece;
+            uint32_t priority{ 0 };
+
+            // totals of the whole subtree including this node
+            size_t length{ 0 };
+            size_t line_feeds{ 0 };
+        };
+
+        static NodePtr make_node(const NodePtr& left, const Piece& piece, uint32_t priority, const NodePtr& right);
+
+        static std::pair<NodePtr, NodePtr> split(const NodePtr& node, size_t offset);
+        static NodePtr merge(const NodePtr& a, const NodePtr& b);
+
+        // builds a balanced tree out of pieces that are already in order
+        static NodePtr build(const std::vector<Piece>& pieces);
+
+        // returns a copy of node where the last piece is replaced by piece
+        static NodePtr replace_last(const NodePtr& node, const Piece& piece);
+        static const Piece* last_piece(const NodePtr& node);
+
+        static Piece make_piece(std::shared_ptr<const char> data, size_t length);
+        static std::pair<Piece, Piece> split_piece(const Piece& piece, size_t offset);
+
+        static uint32_t random_priority();
+
+        // copies text into the add buffer and cuts it into pieces
+        std::vector<Piece> append_to_add_buffer(std::string_view text);
+
+    private:
+        NodePtr m_root;
+
+        std::shared_ptr<char[]> m_add;
+        size_t m_add_used{ 0 };
+        size_t m_add_capacity{ 0 };
+    };
+}
@@ -0,0 +1,436 @@
+#include "project_search.h"
+#include "common.h"
+#include "mapped_file.h"
+#include "line_index.h"
+#include "text_search.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <memory>
+#include <cstring>
+
+#if defined(_WIN32)
+#  define PATH_SLASH '\\'
+#else
+#  define PATH_SLASH '/'
+#endif /* if defined(_WIN32) */
+
+#define MAX_THREADS 8
+// files this big are mapped instead of read, mapping costs more than reading a small file
+#define MAP_THRESHOLD (256 * 1024)
+// a file with a 0 byte in this many bytes from the start is taken to be binary and skipped
+#define BINARY_CHECK_BYTES 8192
+// the search stops after this many matches, nobody is going to look through more
+#define MAX_MATCHES 100000
+// how much of the line is kept before the match, and how much of it is kept at most
+#define PREVIEW_BEFORE 40
+#define MAX_PREVIEW 200
+
+namespace fs = std::filesystem;
+
+
+gui::ProjectSearch::ProjectSearch(int threads)
+{
+    if (threads <= 0)
+        threads = std::clamp((int)std::thread::hardware_concurrency(), 2, MAX_THREADS);
+
+    // the queues have to all exist before any thread starts stealing from them
+    m_queues = std::vector<Queue>(threads);
+
+    for (int i = 0; i < threads; ++i)
+        m_threads.emplace_back(&ProjectSearch::work, this, i);
+}
+
+
+gui::ProjectSearch::~ProjectSearch()
+{
+    cancel();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+
+    m_wake.notify_all();
+
+    for (auto& t : m_threads)
+        t.join();
+}
+
+
+void gui::ProjectSearch::start(const std::string& root, const std::string& query)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        ++m_generation;
+        m_root = root;
+        m_query = query;
+
+        for (auto& queue : m_queues)
+        {
+            std::lock_guard<std::mutex> queue_lock(queue.mutex);
+
+            m_queued -= queue.tasks.size();
+            queue.tasks.clear();
+        }
+
+        m_results.clear();
+        m_match_count = 0;
+        m_truncated = false;
+        m_files_searched = 0;
+        m_bytes_searched = 0;
+
+        if (query.empty())
+        {
+            m_pending = 0;
+            m_searching = false;
+
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> queue_lock(m_queues[0].mutex);
+
+            m_queues[0].tasks.push_back({ "", true, m_generation });
+            ++m_queued;
+        }
+
+        m_pending = 1;
+        m_searching = true;
+    }
+
+    m_wake.notify_all();
+}
+
+
+void gui::ProjectSearch::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ++m_generation;
+
+    for (auto& queue : m_queues)
+    {
+        std::lock_guard<std::mutex> queue_lock(queue.mutex);
+
+        m_queued -= queue.tasks.size();
+        queue.tasks.clear();
+    }
+
+    m_results.clear();
+    m_pending = 0;
+    m_searching = false;
+}
+
+
+bool gui::ProjectSearch::take(std::vector<Match>& matches)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_results.empty())
+        return false;
+
+    matches.insert(matches.end(), std::make_move_iterator(m_results.begin()), std::make_move_iterator(m_results.end()));
+    m_results.clear();
+
+    return true;
+}
+
+
+void gui::ProjectSearch::work(int worker)
+{
+    // copies of the root and query of the search the last task was for, so they dont have to be locked for every file
+    uint64_t generation = 0;
+    std::string root;
+    std::string query;
+
+    std::vector<char> buffer;
+
+    while (true)
+    {
+        Task task;
+
+        if (!next_task(worker, task))
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_quit || m_queued > 0; });
+
+            if (m_quit)
+                return;
+
+            continue;
+        }
+
+        if (task.generation != generation)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            generation = task.generation;
+            root = m_root;
+            query = m_query;
+        }
+
+        std::vector<Task> found;
+
+        // once the search is out of date or has enough matches whatever is left is only taken off the queues
+        if (task.generation == m_generation && !m_truncated)
+        {
+            if (task.directory)
+            {
+                found = list(root, task.path, task.generation);
+            }
+            else
+            {
+                std::vector<Match> matches = search(root, task.path, query, task.generation, buffer);
+
+                if (!matches.empty())
+                    publish(matches, task.generation);
+            }
+        }
+
+        finish_task(worker, found, task.generation);
+    }
+}
+
+
+bool gui::ProjectSearch::next_task(int worker, Task& task)
+{
+    int count = (int)m_queues.size();
+
+    // the newest task of this thread is usually in a folder it just listed, so its files are still cached
+    for (int i = 0; i < count; ++i)
+    {
+        Queue& queue = m_queues[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty())
+            continue;
+
+        if (i == 0)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+
+        --m_queued;
+
+        return true;
+    }
+
+    return false;
+}
+
+
+std::vector<gui::ProjectSearch::Task> gui::ProjectSearch::list(const std::string& root, const std::string& path, uint64_t generation)
+{
+    std::vector<Task> tasks;
+
+    std::error_code ec;
+    fs::directory_iterator it(path.empty() ? root : root + PATH_SLASH + path, ec);
+
+    for (; !ec && it != fs::directory_iterator(); it.increment(ec))
+    {
+        if (m_generation != generation)
+            break;
+
+        std::string name = it->path().filename().string();
+
+        // backups and journals
+        if (name.empty() || name.back() == '~')
+            continue;
+
+        std::string child = path.empty() ? name : path + PATH_SLASH + name;
+        std::error_code type_ec;
+
+        // symlinked folders arent followed, they can make a folder contain itself
+        if (it->is_symlink(type_ec))
+        {
+            if (it->is_regular_file(type_ec))
+                tasks.push_back({ std::move(child), false, generation });
+
+            continue;
+        }
+
+        if (it->is_directory(type_ec))
+        {
+            // .git and friends
+            if (name[0] != '.')
+                tasks.push_back({ std::move(child), true, generation });
+        }
+        else if (it->is_regular_file(type_ec))
+        {
+            tasks.push_back({ std::move(child), false, generation });
+        }
+    }
+
+    return tasks;
+}
+
+
+std::vector<gui::ProjectSearch::Match> gui::ProjectSearch::search(const std::string& root, const std::string& path, const std::string& query, uint64_t generation, std::vector<char>& buffer)
+{
+    std::vector<Match> matches;
+    std::string full_path = root + PATH_SLASH + path;
+
+    std::error_code ec;
+    size_t size = (size_t)fs::file_size(full_path, ec);
+
+    if (ec || size < query.size())
+        return matches;
+
+    const char* data;
+    size_t length;
+    std::unique_ptr<MappedFile> mapped;
+
+    if (size >= MAP_THRESHOLD)
+    {
+        mapped = std::make_unique<MappedFile>(full_path);
+
+        if (!mapped->is_open())
+            return matches;
+
+        data = mapped->data();
+        length = mapped->size();
+    }
+    else
+    {
+        std::ifstream ifs(full_path, std::ios::binary);
+
+        if (!ifs)
+            return matches;
+
+        buffer.resize(size);
+        ifs.read(buffer.data(), size);
+
+        data = buffer.data();
+        length = (size_t)ifs.gcount();
+    }
+
+    m_files_searched++;
+    m_bytes_searched += length;
+
+    if (memchr(data, 0, std::min(length, (size_t)BINARY_CHECK_BYTES)))
+        return matches;
+
+    // lines are only counted up to each match, a file without one is only read once
+    size_t line = 0;
+    size_t counted = 0;
+    size_t pos = 0;
+
+    while (pos < length && m_generation == generation)
+    {
+        size_t hit = text_search::find(data + pos, length - pos, query);
+
+        if (hit == text_search::npos)
+            break;
+
+        hit += pos;
+
+        line += line_index::count_new_lines(data + counted, hit - counted);
+        counted = hit;
+
+        // everything from pos to the match is on lines before it or on its line, so this never goes further back than that
+        size_t line_start = hit;
+
+        while (line_start > pos && data[line_start - 1] != '\n')
+            --line_start;
+
+        const char* nl = (const char*)memchr(data + hit, '\n', length - hit);
+        size_t line_end = nl ? nl - data : length;
+
+        size_t from = line_start;
+
+        while (from < hit && (data[from] == ' ' || data[from] == '\t'))
+            ++from;
+
+        from = std::max(from, hit - std::min(hit, (size_t)PREVIEW_BEFORE));
+        size_t to = std::min(line_end, from + MAX_PREVIEW);
+
+        Match match{ path, (int)line, (int)(hit - line_start), std::string(data + from, to - from) };
+
+        for (char& c : match.text)
+        {
+            if (c == '\t' || c == '\r')
+                c = ' ';
+        }
+
+        matches.emplace_back(std::move(match));
+
+        // one match per line, the next search starts on the line after
+        pos = line_end + 1;
+    }
+
+    return matches;
+}
+
+
+void gui::ProjectSearch::finish_task(int worker, std::vector<Task>& tasks, uint64_t generation)
+{
+    bool done = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (generation != m_generation)
+            return;
+
+        // the new tasks are counted before this one is taken off, so m_pending cant get to 0 in between
+        if (!tasks.empty())
+        {
+            std::lock_guard<std::mutex> queue_lock(m_queues[worker].mutex);
+
+            for (auto& task : tasks)
+                m_queues[worker].tasks.push_back(std::move(task));
+
+            m_queued += tasks.size();
+            m_pending += tasks.size();
+        }
+
+        if (--m_pending == 0)
+        {
+            m_searching = false;
+            done = true;
+        }
+    }
+
+    if (!tasks.empty())
+        m_wake.notify_all();
+
+    if (done)
+        common::wake_main_loop();
+}
+
+
+void gui::ProjectSearch::publish(std::vector<Match>& matches, uint64_t generation)
+{
+    bool wake;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (generation != m_generation || m_truncated)
+            return;
+
+        if (m_match_count + matches.size() >= MAX_MATCHES)
+        {
+            matches.resize(MAX_MATCHES - m_match_count);
+            m_truncated = true;
+        }
+
+        m_match_count += matches.size();
+
+        // the main loop only needs waking up once until it takes what is there
+        wake = m_results.empty();
+
+        m_results.insert(m_results.end(), std::make_move_iterator(matches.begin()), std::make_move_iterator(matches.end()));
+    }
+
+    if (wake)
+        common::wake_main_loop();
+}
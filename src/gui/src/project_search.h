@@ -0,0 +1,111 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+
+namespace gui
+{
+    /* Finds a string in every file under a folder, on a pool of threads.
+    * Every folder and file is a task, a thread takes the newest task it made itself and steals the oldest one
+    * of another thread when it runs out, so one huge folder gets spread out over every thread.
+    * Matches are handed out by take as they are found, while the rest of the files are still being searched.
+    */
+    class ProjectSearch
+    {
+    public:
+        struct Match
+        {
+            // relative to the root
+            std::string path;
+            // both start at 0, column is in bytes
+            int line;
+            int column;
+
+            // the line the match is on, tabs turned into spaces and cut short if it is long
+            std::string text;
+        };
+
+        // threads is how many files are searched at the same time, 0 picks something based on the cpu
+        explicit ProjectSearch(int threads = 0);
+        ~ProjectSearch();
+
+        ProjectSearch(const ProjectSearch&) = delete;
+        ProjectSearch& operator=(const ProjectSearch&) = delete;
+
+        // stops whatever was being searched for and starts looking for query in everything under root
+        void start(const std::string& root, const std::string& query);
+        void cancel();
+
+        // appends everything found since the last call to matches, returns false if there was nothing
+        bool take(std::vector<Match>& matches);
+
+        bool searching() const { return m_searching; }
+        // stopped at MAX_MATCHES matches, there were more
+        bool truncated() const { return m_truncated; }
+
+        size_t files_searched() const { return m_files_searched; }
+        size_t bytes_searched() const { return m_bytes_searched; }
+
+    private:
+        struct Task
+        {
+            // relative to the root, empty for the root itself
+            std::string path;
+            bool directory;
+            // the search it is for, anything older than m_generation is dropped
+            uint64_t generation;
+        };
+
+        // every thread owns one of these, other threads only take from the front
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void work(int worker);
+        // takes the newest task of worker, or steals the oldest one of another thread
+        bool next_task(int worker, Task& task);
+
+        // returns the folders and files in the folder path
+        std::vector<Task> list(const std::string& root, const std::string& path, uint64_t generation);
+        // returns the matches of query in the file at path, buffer is reused for files that arent mapped
+        std::vector<Match> search(const std::string& root, const std::string& path, const std::string& query, uint64_t generation, std::vector<char>& buffer);
+
+        // queues the tasks a task made, and marks the task as done
+        void finish_task(int worker, std::vector<Task>& tasks, uint64_t generation);
+        void publish(std::vector<Match>& matches, uint64_t generation);
+
+    private:
+        std::vector<std::thread> m_threads;
+        std::vector<Queue> m_queues;
+        std::atomic<size_t> m_queued{ 0 };
+
+        // only changed under m_mutex, read by the threads to tell if what they are doing is out of date
+        std::atomic<uint64_t> m_generation{ 0 };
+        std::string m_root;
+        std::string m_query;
+
+        std::atomic<bool> m_searching{ false };
+        std::atomic<bool> m_truncated{ false };
+        std::atomic<size_t> m_files_searched{ 0 };
+        std::atomic<size_t> m_bytes_searched{ 0 };
+
+        // everything below is guarded by m_mutex
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+
+        // tasks queued or still running for the current search, it is done once this gets to 0
+        size_t m_pending{ 0 };
+        std::vector<Match> m_results;
+        size_t m_match_count{ 0 };
+
+        bool m_quit{ false };
+    };
+}
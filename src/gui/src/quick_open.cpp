@@ -0,0 +1,210 @@
+#include "quick_open.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#  define PATH_SLASH '\\'
+#else
+#  define PATH_SLASH '/'
+#endif /* if defined(_WIN32) */
+
+// results shown at once
+#define QUICK_OPEN_ROWS 15
+#define QUICK_OPEN_WIDTH 800
+#define QUICK_OPEN_TOP 50
+#define QUICK_OPEN_PADDING 6
+
+
+gui::QuickOpen::QuickOpen(common::Font& font)
+    : m_font(font.font()), m_char_dim(font.char_dim())
+{
+}
+
+
+void gui::QuickOpen::set_root(const std::string& root)
+{
+    m_index.build(root);
+    m_index.search(m_query);
+
+    m_results = PathIndex::Results();
+    m_selected = 0;
+    m_dirty = true;
+}
+
+
+void gui::QuickOpen::show()
+{
+    m_shown = true;
+    m_dirty = true;
+
+    m_query.clear();
+    m_index.search(m_query);
+    m_selected = 0;
+}
+
+
+void gui::QuickOpen::hide()
+{
+    m_shown = false;
+    m_dirty = true;
+}
+
+
+void gui::QuickOpen::insert_text(const char* text)
+{
+    m_query += text;
+    m_index.search(m_query);
+
+    m_selected = 0;
+    m_dirty = true;
+}
+
+
+void gui::QuickOpen::remove_char()
+{
+    if (m_query.empty())
+        return;
+
+    common::pop_utf8(m_query);
+    m_index.search(m_query);
+
+    m_selected = 0;
+    m_dirty = true;
+}
+
+
+void gui::QuickOpen::move_selection(int by)
+{
+    if (m_results.paths.empty())
+        return;
+
+    m_selected = std::clamp(m_selected + by, 0, (int)m_results.paths.size() - 1);
+    m_dirty = true;
+}
+
+
+std::string gui::QuickOpen::selected_path() const
+{
+    if (m_selected >= (int)m_results.paths.size())
+        return "";
+
+    return full_path(m_results.paths[m_selected]);
+}
+
+
+std::string gui::QuickOpen::path_at(int mx, int my) const
+{
+    int first = first_shown();
+
+    for (int row = 0; row < QUICK_OPEN_ROWS && first + row < (int)m_results.paths.size(); ++row)
+    {
+        if (common::within_rect(row_rect(row), mx, my))
+            return full_path(m_results.paths[first + row]);
+    }
+
+    return "";
+}
+
+
+void gui::QuickOpen::update()
+{
+    m_index.update();
+
+    if (m_index.take_results(m_results))
+    {
+        m_selected = std::min(m_selected, std::max(0, (int)m_results.paths.size() - 1));
+        m_dirty |= m_shown;
+    }
+
+    if (m_index.building() != m_building)
+    {
+        m_building = m_index.building();
+        m_dirty |= m_shown;
+    }
+}
+
+
+void gui::QuickOpen::render(SDL_Renderer* rend, int window_w)
+{
+    m_dirty = false;
+
+    if (!m_shown)
+        return;
+
+    if (!m_atlas)
+        m_atlas = std::make_unique<GlyphAtlas>(rend, m_font, m_char_dim);
+
+    int w = std::min(QUICK_OPEN_WIDTH, window_w - 40);
+    int rows = std::min(QUICK_OPEN_ROWS, (int)m_results.paths.size());
+
+    m_rect = {
+        (window_w - w) / 2,
+        QUICK_OPEN_TOP,
+        w,
+        (rows + 1) * m_char_dim.y + QUICK_OPEN_PADDING * 2
+    };
+
+    SDL_SetRenderDrawColor(rend, 35, 35, 35, 255);
+    SDL_RenderFillRect(rend, &m_rect);
+    SDL_SetRenderDrawColor(rend, 90, 90, 90, 255);
+    SDL_RenderDrawRect(rend, &m_rect);
+
+    int x = m_rect.x + QUICK_OPEN_PADDING;
+    int y = m_rect.y + QUICK_OPEN_PADDING;
+    int columns = (m_rect.w - QUICK_OPEN_PADDING * 2) / m_char_dim.x;
+
+    // the query is only what the results are for once they catch up, the count says how far along it is
+    std::string count = std::to_string(m_results.matched) + "/" + std::to_string(m_results.total) + (m_building ? " indexing" : "");
+    int count_x = m_rect.x + m_rect.w - QUICK_OPEN_PADDING - (int)count.size() * m_char_dim.x;
+
+    m_atlas->add_text("> " + m_query, x, y, { 255, 255, 255, 255 });
+    m_atlas->add_text(count, count_x, y, { 150, 150, 150, 255 });
+
+    SDL_Rect cursor = { x + (int)(m_query.size() + 2) * m_char_dim.x, y, 2, m_char_dim.y };
+    SDL_SetRenderDrawColor(rend, 255, 255, 255, 255);
+    SDL_RenderFillRect(rend, &cursor);
+
+    int first = first_shown();
+
+    for (int row = 0; row < rows && first + row < (int)m_results.paths.size(); ++row)
+    {
+        const std::string& path = m_results.paths[first + row];
+        SDL_Rect rect = row_rect(row);
+
+        if (first + row == m_selected)
+        {
+            SDL_SetRenderDrawColor(rend, 70, 70, 70, 255);
+            SDL_RenderFillRect(rend, &rect);
+        }
+
+        // the end of a long path is cut off from the front, the file name is what matters
+        if ((int)path.size() > columns)
+            m_atlas->add_text("..." + path.substr(path.size() - std::max(0, columns - 3)), x, rect.y, { 255, 255, 255, 255 });
+        else
+            m_atlas->add_text(path, x, rect.y, { 255, 255, 255, 255 });
+    }
+
+    m_atlas->render();
+}
+
+
+std::string gui::QuickOpen::full_path(const std::string& relative) const
+{
+    return m_index.root() + PATH_SLASH + relative;
+}
+
+
+int gui::QuickOpen::first_shown() const
+{
+    return std::max(0, m_selected - QUICK_OPEN_ROWS + 1);
+}
+
+
+SDL_Rect gui::QuickOpen::row_rect(int row) const
+{
+    return {
+        m_rect.x + 1,
+        m_rect.y + QUICK_OPEN_PADDING + (row + 1) * m_char_dim.y,
+        m_rect.w - 2,
+        m_char_dim.y
+    };
+}
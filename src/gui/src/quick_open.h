@@ -0,0 +1,69 @@
+#pragma once
+#include "common.h"
+#include "glyph_atlas.h"
+#include "path_index.h"
+#include <string>
+#include <memory>
+#include <SDL.h>
+
+
+namespace gui
+{
+    /* Box at the top of the window that opens a file by typing part of its path.
+    * Everything under the open folder is indexed in the background as soon as the folder is opened,
+    * so the index is usually done by the time it is shown.
+    */
+    class QuickOpen
+    {
+    public:
+        QuickOpen(common::Font& font);
+
+        // starts indexing everything under root, the paths handed out start with root
+        void set_root(const std::string& root);
+
+        void show();
+        void hide();
+        bool shown() const { return m_shown; }
+
+        void insert_text(const char* text);
+        void remove_char();
+        void move_selection(int by);
+
+        // full path of the selected result, empty if there is none
+        std::string selected_path() const;
+        // full path of the result at (mx, my), empty if there isnt one there
+        std::string path_at(int mx, int my) const;
+
+        // picks up new results and whatever was indexed since the last call
+        void update();
+
+        // true if something changed since the last render
+        bool dirty() const { return m_dirty; }
+        void render(SDL_Renderer* rend, int window_w);
+
+    private:
+        std::string full_path(const std::string& relative) const;
+        // first result shown, the list scrolls to keep the selected one on screen
+        int first_shown() const;
+        SDL_Rect row_rect(int row) const;
+
+    private:
+        PathIndex m_index;
+
+        std::string m_query;
+        PathIndex::Results m_results;
+        int m_selected{ 0 };
+
+        bool m_shown{ false };
+        bool m_building{ false };
+        bool m_dirty{ true };
+
+        // where the box was last drawn, rows are right under the query
+        SDL_Rect m_rect{ 0, 0, 0, 0 };
+
+        std::unique_ptr<GlyphAtlas> m_atlas;
+        // non owning, dont free
+        TTF_Font* m_font;
+        SDL_Point m_char_dim;
+    };
+}
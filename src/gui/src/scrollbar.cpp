@@ -19,6 +19,11 @@ gui::Scrollbar::Scrollbar(SDL_Rect rect, int min_bar_bound, int max_bar_bound, i
 
 void gui::Scrollbar::render(SDL_Renderer* rend)
 {
+    m_dirty = false;
+
+    if (m_hidden)
+        return;
+
     SDL_SetRenderDrawColor(rend, m_bg_color.r, m_bg_color.g, m_bg_color.b, 255);
     SDL_RenderFillRect(rend, &m_rect);
 
@@ -34,23 +39,31 @@ void gui::Scrollbar::move(int x, int y)
 
     m_rect.y += y;
     m_bar_rect.y += y;
+
+    m_dirty = true;
 }
 
 
 void gui::Scrollbar::resize(int window_h)
 {
     m_rect.h = window_h - m_rect.y;
+    m_dirty = true;
 }
 
 
 void gui::Scrollbar::set_bounds(int min_bar_bound, int max_bar_bound, int total_size)
 {
+    SDL_Rect prev = m_bar_rect;
+
     m_total_bar_height = total_size;
     
     m_bar_rect.y = y_to_bar_pos(min_bar_bound);
     m_bar_rect.h = y_to_bar_pos(max_bar_bound - min_bar_bound + 1);
 
     m_bar_rect.y += m_rect.y;
+
+    if (prev.y != m_bar_rect.y || prev.h != m_bar_rect.h)
+        m_dirty = true;
 }
 
 
@@ -85,6 +98,7 @@ void gui::Scrollbar::mouse_up()
 void gui::Scrollbar::move_with_cursor(int my)
 {
     float pixels_per_unit = (float)m_rect.h / (float)m_total_bar_height;
+    int prev_y = m_bar_rect.y;
 
     int new_pos = (my - m_bar_and_mouse_diff - m_rect.y);
     m_bar_rect.y = m_rect.y + new_pos;
@@ -93,6 +107,9 @@ void gui::Scrollbar::move_with_cursor(int my)
 
     m_bar_rect.y = std::min(m_bar_rect.y, m_rect.y + m_rect.h - m_bar_rect.h);
     m_bar_rect.y = std::max(m_bar_rect.y, m_rect.y);
+
+    if (prev_y != m_bar_rect.y)
+        m_dirty = true;
 }
 
 
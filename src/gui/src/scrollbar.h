@@ -35,10 +35,12 @@ namespace gui
 
         bool down() { return m_down; }
 
-        void hide() { m_hidden = true; }
-        void show() { m_hidden = false; }
+        void hide() { m_hidden = true; m_dirty = true; }
+        void show() { m_hidden = false; m_dirty = true; }
 
         bool hidden() { return m_hidden; }
+        // true if something changed since the last render
+        bool dirty() { return m_dirty; }
 
     private:
         SDL_Rect m_rect;
@@ -52,5 +54,6 @@ namespace gui
         int m_bar_and_mouse_diff{ 0 };
 
         bool m_hidden{ false };
+        bool m_dirty{ true };
     };
 }
\ No newline at end of file
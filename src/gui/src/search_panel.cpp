@@ -0,0 +1,247 @@
+#include "search_panel.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#  define PATH_SLASH '\\'
+#else
+#  define PATH_SLASH '/'
+#endif /* if defined(_WIN32) */
+
+#define SEARCH_PANEL_WIDTH 1000
+#define SEARCH_PANEL_MARGIN 50
+#define SEARCH_PANEL_PADDING 6
+
+
+gui::SearchPanel::SearchPanel(common::Font& font)
+    : m_font(font.font()), m_char_dim(font.char_dim())
+{
+}
+
+
+void gui::SearchPanel::set_root(const std::string& root)
+{
+    m_root = root;
+    m_search.cancel();
+
+    m_searched_query.clear();
+    m_matches.clear();
+    m_selected = 0;
+    m_first = 0;
+    m_searching = false;
+    m_dirty = true;
+}
+
+
+void gui::SearchPanel::show()
+{
+    m_shown = true;
+    m_dirty = true;
+}
+
+
+void gui::SearchPanel::hide()
+{
+    m_shown = false;
+    m_dirty = true;
+}
+
+
+void gui::SearchPanel::insert_text(const char* text)
+{
+    m_query += text;
+    m_dirty = true;
+}
+
+
+void gui::SearchPanel::remove_char()
+{
+    if (m_query.empty())
+        return;
+
+    common::pop_utf8(m_query);
+    m_dirty = true;
+}
+
+
+bool gui::SearchPanel::search()
+{
+    if (m_query == m_searched_query)
+        return false;
+
+    m_search.start(m_root, m_query);
+
+    m_searched_query = m_query;
+    m_matches.clear();
+    m_selected = 0;
+    m_first = 0;
+    m_searching = m_search.searching();
+    m_dirty = true;
+
+    return true;
+}
+
+
+void gui::SearchPanel::move_selection(int by)
+{
+    if (m_matches.empty())
+        return;
+
+    m_selected = std::clamp(m_selected + by, 0, (int)m_matches.size() - 1);
+    scroll_to_selected();
+
+    m_dirty = true;
+}
+
+
+void gui::SearchPanel::scroll(int rows)
+{
+    int first = std::clamp(m_first + rows, 0, std::max(0, (int)m_matches.size() - m_rows));
+
+    if (first == m_first)
+        return;
+
+    m_first = first;
+    m_dirty = true;
+}
+
+
+bool gui::SearchPanel::selected(Location& location) const
+{
+    if (m_selected >= (int)m_matches.size())
+        return false;
+
+    location = this->location(m_selected);
+    return true;
+}
+
+
+bool gui::SearchPanel::location_at(int mx, int my, Location& location) const
+{
+    for (int row = 0; row < m_rows && m_first + row < (int)m_matches.size(); ++row)
+    {
+        if (common::within_rect(row_rect(row), mx, my))
+        {
+            location = this->location(m_first + row);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void gui::SearchPanel::update()
+{
+    // the matches keep their order, new ones only ever go after the ones on screen
+    if (m_search.take(m_matches))
+        m_dirty |= m_shown;
+
+    if (m_search.searching() != m_searching)
+    {
+        m_searching = m_search.searching();
+        m_dirty |= m_shown;
+    }
+}
+
+
+void gui::SearchPanel::render(SDL_Renderer* rend, int window_w, int window_h)
+{
+    m_dirty = false;
+
+    if (!m_shown)
+        return;
+
+    if (!m_atlas)
+        m_atlas = std::make_unique<GlyphAtlas>(rend, m_font, m_char_dim);
+
+    int w = std::min(SEARCH_PANEL_WIDTH, window_w - 40);
+    int h = std::max(m_char_dim.y * 2 + SEARCH_PANEL_PADDING * 2, window_h - SEARCH_PANEL_MARGIN * 2);
+
+    m_rect = { (window_w - w) / 2, SEARCH_PANEL_MARGIN, w, h };
+    m_rows = std::max(1, (h - SEARCH_PANEL_PADDING * 2) / m_char_dim.y - 1);
+    m_first = std::clamp(m_first, 0, std::max(0, (int)m_matches.size() - m_rows));
+
+    SDL_SetRenderDrawColor(rend, 35, 35, 35, 255);
+    SDL_RenderFillRect(rend, &m_rect);
+    SDL_SetRenderDrawColor(rend, 90, 90, 90, 255);
+    SDL_RenderDrawRect(rend, &m_rect);
+
+    int x = m_rect.x + SEARCH_PANEL_PADDING;
+    int y = m_rect.y + SEARCH_PANEL_PADDING;
+    int columns = (m_rect.w - SEARCH_PANEL_PADDING * 2) / m_char_dim.x;
+
+    std::string count = std::to_string(m_matches.size()) + " matches";
+
+    if (m_searching)
+        count += ", searching";
+    else if (m_search.truncated())
+        count += ", stopped";
+
+    if (m_query != m_searched_query)
+        count = "enter to search";
+
+    int count_x = m_rect.x + m_rect.w - SEARCH_PANEL_PADDING - (int)count.size() * m_char_dim.x;
+
+    m_atlas->add_text("find: " + m_query, x, y, { 255, 255, 255, 255 });
+    m_atlas->add_text(count, count_x, y, { 150, 150, 150, 255 });
+
+    SDL_Rect cursor = { x + (int)(m_query.size() + 6) * m_char_dim.x, y, 2, m_char_dim.y };
+    SDL_SetRenderDrawColor(rend, 255, 255, 255, 255);
+    SDL_RenderFillRect(rend, &cursor);
+
+    // only the rows on screen are looked at
+    for (int row = 0; row < m_rows && m_first + row < (int)m_matches.size(); ++row)
+    {
+        const ProjectSearch::Match& match = m_matches[m_first + row];
+        SDL_Rect rect = row_rect(row);
+
+        if (m_first + row == m_selected)
+        {
+            SDL_SetRenderDrawColor(rend, 70, 70, 70, 255);
+            SDL_RenderFillRect(rend, &rect);
+        }
+
+        std::string where = match.path + ":" + std::to_string(match.line + 1) + " ";
+        int room = columns - (int)where.size();
+
+        // the file name matters more than the folders it is in
+        if (room < columns / 2 && columns > 6)
+        {
+            where = "..." + where.substr(where.size() - columns / 2 + 3);
+            room = columns - (int)where.size();
+        }
+
+        m_atlas->add_text(where, x, rect.y, { 150, 150, 150, 255 });
+        m_atlas->add_text(std::string_view(match.text).substr(0, std::max(0, room)), x + (int)where.size() * m_char_dim.x, rect.y, { 255, 255, 255, 255 });
+    }
+
+    m_atlas->render();
+}
+
+
+gui::SearchPanel::Location gui::SearchPanel::location(int i) const
+{
+    const ProjectSearch::Match& match = m_matches[i];
+
+    return { m_root + PATH_SLASH + match.path, match.line, match.column };
+}
+
+
+SDL_Rect gui::SearchPanel::row_rect(int row) const
+{
+    return {
+        m_rect.x + 1,
+        m_rect.y + SEARCH_PANEL_PADDING + (row + 1) * m_char_dim.y,
+        m_rect.w - 2,
+        m_char_dim.y
+    };
+}
+
+
+void gui::SearchPanel::scroll_to_selected()
+{
+    if (m_selected < m_first)
+        m_first = m_selected;
+    else if (m_selected >= m_first + m_rows)
+        m_first = m_selected - m_rows + 1;
+}
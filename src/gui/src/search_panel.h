@@ -0,0 +1,91 @@
+#pragma once
+#include "common.h"
+#include "glyph_atlas.h"
+#include "project_search.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <SDL.h>
+
+
+namespace gui
+{
+    /* Box over the editor that searches every file under the open folder for what is typed into it.
+    * Matches show up while the rest of the files are still being searched, only the rows on screen are ever drawn
+    * so it doesnt matter how many there are.
+    */
+    class SearchPanel
+    {
+    public:
+        struct Location
+        {
+            std::string path;
+            // both start at 0
+            int line;
+            int column;
+        };
+
+        SearchPanel(common::Font& font);
+
+        // stops the current search, the paths handed out start with root
+        void set_root(const std::string& root);
+
+        void show();
+        void hide();
+        bool shown() const { return m_shown; }
+
+        void insert_text(const char* text);
+        void remove_char();
+
+        // starts searching for what was typed, returns false if the results are already for that
+        bool search();
+
+        void move_selection(int by);
+        void scroll(int rows);
+
+        // returns false if nothing is selected
+        bool selected(Location& location) const;
+        // returns false if there isnt a result at (mx, my)
+        bool location_at(int mx, int my, Location& location) const;
+        bool contains(int mx, int my) const { return m_shown && common::within_rect(m_rect, mx, my); }
+
+        // picks up whatever was found since the last call
+        void update();
+
+        // true if something changed since the last render
+        bool dirty() const { return m_dirty; }
+        void render(SDL_Renderer* rend, int window_w, int window_h);
+
+    private:
+        Location location(int i) const;
+        SDL_Rect row_rect(int row) const;
+        // keeps the selected result on screen
+        void scroll_to_selected();
+
+    private:
+        ProjectSearch m_search;
+        std::string m_root;
+
+        std::string m_query;
+        // what the results are for
+        std::string m_searched_query;
+        std::vector<ProjectSearch::Match> m_matches;
+
+        int m_selected{ 0 };
+        // first result on screen, and how many fit
+        int m_first{ 0 };
+        int m_rows{ 1 };
+
+        bool m_shown{ false };
+        bool m_searching{ false };
+        bool m_dirty{ true };
+
+        // where the box was last drawn, rows are right under the query
+        SDL_Rect m_rect{ 0, 0, 0, 0 };
+
+        std::unique_ptr<GlyphAtlas> m_atlas;
+        // non owning, dont free
+        TTF_Font* m_font;
+        SDL_Point m_char_dim;
+    };
+}
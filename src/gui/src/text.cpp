@@ -1,6 +1,6 @@
 #include "text.h"
 #include "common.h"
-#include <sstream>
+#include <algorithm>
 
 
 gui::Text::Text(TTF_Font* font, SDL_Point pos, const std::string& contents, SDL_Point char_dimensions, SDL_Color col)
@@ -8,56 +8,362 @@ gui::Text::Text(TTF_Font* font, SDL_Point pos, const std::string& contents, SDL_
 {
     m_rect = { pos.x, pos.y, char_dimensions.x * (int)contents.size(), char_dimensions.y };
 
-    std::string line;
-    std::stringstream ss(contents);
-    while (std::getline(ss, line)) m_contents.emplace_back(line);
-
-    if (m_contents.empty())
-        m_contents.emplace_back("");
+    set_str(contents);
 }
 
 
 void gui::Text::insert(int x, int y, char c)
 {
-    if (m_contents.size() == 0)
-        m_contents.emplace_back("");
+    make_editable();
 
-    if (c == '\n')
-        m_contents.insert(m_contents.begin() + y + 1, "");
-    else
-        m_contents[y].insert(m_contents[y].begin() + x, c);
+    insert_contents(offset(x, y), std::string_view(&c, 1));
 }
 
 
 void gui::Text::erase(int x, int y, bool erase_nl)
 {
-    if (m_contents[y].empty())
+    make_editable();
+
+    if (m_contents.line_length(y) == 0)
     {
         if (!erase_nl)
             return;
 
-        if (m_contents.size() > 1)
-            m_contents.erase(m_contents.begin() + y);
+        if (m_contents.line_count() > 1)
+            remove_line(y);
     }
     else
     {
-        m_contents[y].erase(m_contents[y].begin() + x);
+        erase_contents(offset(x, y), 1);
     }
 }
 
 
+void gui::Text::erase_section(int x, int y, int count)
+{
+    make_editable();
+
+    int length = (int)m_contents.line_length(y);
+
+    x = std::clamp(x, 0, length);
+    count = std::clamp(count, 0, length - x);
+
+    erase_contents(offset(x, y), count);
+}
+
+
+void gui::Text::insert_text(SDL_Point pos, std::string_view text)
+{
+    make_editable();
+
+    insert_contents(offset(pos.x, std::min(pos.y, (int)m_contents.line_count() - 1)), text);
+}
+
+
+void gui::Text::erase_range(SDL_Point from, SDL_Point to)
+{
+    make_editable();
+
+    int last_line = (int)m_contents.line_count() - 1;
+
+    size_t first = offset(from.x, std::min(from.y, last_line));
+    size_t last = offset(to.x, std::min(to.y, last_line));
+
+    if (last < first)
+        std::swap(first, last);
+
+    erase_contents(first, last - first);
+}
+
+
+std::string gui::Text::copy_range(SDL_Point from, SDL_Point to) const
+{
+    int last_line = line_count() - 1;
+
+    from.y = std::clamp(from.y, 0, last_line);
+    to.y = std::clamp(to.y, 0, last_line);
+
+    if (to.y < from.y || (to.y == from.y && to.x < from.x))
+        std::swap(from, to);
+
+    if (m_mapped)
+    {
+        // lines of a mapped file point straight into it
+        std::string_view first = m_mapped->line(from.y);
+        std::string_view last = m_mapped->line(to.y);
+
+        const char* start = first.data() + std::clamp(from.x, 0, (int)first.size());
+        const char* end = last.data() + std::clamp(to.x, 0, (int)last.size());
+
+        return std::string(start, std::max(start, end));
+    }
+
+    size_t first = offset(from.x, from.y);
+    size_t last = offset(to.x, to.y);
+
+    std::string out;
+    m_contents.copy(first, std::max(first, last) - first, out);
+
+    return out;
+}
+
+
+void gui::Text::remove_line(int i)
+{
+    make_editable();
+
+    if (i < 0 || i >= (int)m_contents.line_count())
+        return;
+
+    size_t start = m_contents.line_offset(i);
+    size_t length = m_contents.line_length(i);
+
+    if (i + 1 < (int)m_contents.line_count())
+        erase_contents(start, length + 1); // the line along with its new line
+    else if (i > 0)
+        erase_contents(start - 1, length + 1); // last line, take the new line before it instead
+    else
+        erase_contents(start, length);
+}
+
+
+void gui::Text::join_line(int i)
+{
+    make_editable();
+
+    if (i < 0 || i + 1 >= (int)m_contents.line_count())
+        return;
+
+    erase_contents(m_contents.line_offset(i + 1) - 1, 1);
+}
+
+
 std::string gui::Text::str()
+{
+    if (m_mapped)
+        return std::string(m_mapped->str());
+
+    return m_contents.str();
+}
+
+
+std::string gui::Text::get_line(int i) const
+{
+    return std::string(line(i));
+}
+
+
+std::string_view gui::Text::line(int i) const
+{
+    if (i < 0 || i >= line_count())
+        return {};
+
+    if (m_mapped)
+        return m_mapped->line(i);
+
+    return m_contents.view(m_contents.line_offset(i), m_contents.line_length(i), m_line_buffer);
+}
+
+
+std::string_view gui::Text::line(int i, int first, int count) const
+{
+    if (i < 0 || i >= line_count() || first < 0 || count <= 0)
+        return {};
+
+    if (m_mapped)
+    {
+        std::string_view l = m_mapped->line(i);
+        return (size_t)first < l.size() ? l.substr(first, count) : std::string_view();
+    }
+
+    size_t length = m_contents.line_length(i);
+
+    if ((size_t)first >= length)
+        return {};
+
+    return m_contents.view(m_contents.line_offset(i) + first, std::min((size_t)count, length - first), m_line_buffer);
+}
+
+
+int gui::Text::line_length(int i) const
+{
+    if (i < 0)
+        return 0;
+
+    if (m_mapped)
+        return (int)m_mapped->line_length(i);
+
+    return (int)m_contents.line_length(i);
+}
+
+
+int gui::Text::line_count() const
+{
+    if (m_mapped)
+        return (int)m_mapped->line_count();
+
+    return (int)m_contents.line_count();
+}
+
+
+gui::Text::Lines gui::Text::lines(int first, int last) const
+{
+    last = std::clamp(last, 0, line_count());
+    first = std::clamp(first, 0, last);
+
+    return { LineIterator(this, first), LineIterator(this, last) };
+}
+
+
+void gui::Text::set_contents(const std::vector<std::string>& contents)
 {
     std::string s;
 
-    for (auto& line : m_contents)
+    for (auto& line : contents)
     {
-        s += line + '\n';
+        s += line;
+        s += '\n';
     }
 
-    if (s.size() == 0)
-        return "";
+    if (!s.empty())
+        s.pop_back();
+
+    m_contents = PieceTable(s);
+    m_mapped = nullptr;
+    ++m_version;
+}
+
+
+void gui::Text::set_str(std::string_view contents)
+{
+    // same as reading the lines with std::getline, a trailing new line doesnt start another line
+    if (!contents.empty() && contents.back() == '\n')
+        contents.remove_suffix(1);
+
+    m_contents = PieceTable(contents);
+    m_mapped = nullptr;
+    ++m_version;
+}
+
+
+void gui::Text::set_line(int i, const std::string& text)
+{
+    make_editable();
+
+    if (i < 0 || i >= (int)m_contents.line_count())
+        return;
 
-    s.pop_back();
-    return s;
-}
\ No newline at end of file
+    size_t start = m_contents.line_offset(i);
+
+    erase_contents(start, m_contents.line_length(i));
+    insert_contents(start, text);
+}
+
+
+void gui::Text::insert_line(int i)
+{
+    make_editable();
+
+    insert_contents(m_contents.line_offset(std::max(i, 0)), "\n");
+}
+
+
+void gui::Text::append(std::string_view text)
+{
+    make_editable();
+
+    m_contents.insert(m_contents.size(), text);
+    ++m_version;
+}
+
+
+void gui::Text::insert_at(size_t offset, std::string_view text)
+{
+    make_editable();
+
+    insert_contents(std::min(offset, m_contents.size()), text);
+}
+
+
+void gui::Text::erase_at(size_t offset, size_t length)
+{
+    make_editable();
+
+    if (offset >= m_contents.size())
+        return;
+
+    erase_contents(offset, std::min(length, m_contents.size() - offset));
+}
+
+
+size_t gui::Text::size() const
+{
+    if (m_mapped)
+        return m_mapped->str().size();
+
+    return m_contents.size();
+}
+
+
+void gui::Text::set_mapped(std::shared_ptr<MappedText> mapped)
+{
+    m_contents = PieceTable();
+    m_mapped = std::move(mapped);
+    ++m_version;
+}
+
+
+bool gui::Text::index_lines(size_t budget)
+{
+    if (!m_mapped)
+        return true;
+
+    return m_mapped->index_more(budget);
+}
+
+
+void gui::Text::make_editable()
+{
+    if (!m_mapped)
+        return;
+
+    m_contents = PieceTable(std::shared_ptr<const char>(m_mapped, m_mapped->data()), m_mapped->str().size());
+    m_mapped = nullptr;
+}
+
+
+void gui::Text::insert_contents(size_t offset, std::string_view text)
+{
+    if (text.empty())
+        return;
+
+    if (m_journal)
+        m_journal->record_insert(offset, text, m_contents.size());
+
+    m_contents.insert(offset, text);
+    ++m_version;
+}
+
+
+void gui::Text::erase_contents(size_t offset, size_t length)
+{
+    if (length == 0 || offset >= m_contents.size())
+        return;
+
+    length = std::min(length, m_contents.size() - offset);
+
+    if (m_journal)
+        m_journal->record_erase(offset, length, m_contents.size());
+
+    m_contents.erase(offset, length);
+    ++m_version;
+}
+
+
+size_t gui::Text::offset(int x, int y) const
+{
+    y = std::max(y, 0);
+    x = std::clamp(x, 0, (int)m_contents.line_length(y));
+
+    return m_contents.line_offset(y) + x;
+}
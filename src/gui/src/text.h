@@ -1,6 +1,11 @@
 #pragma once
+#include "piece_table.h"
+#include "mapped_file.h"
+#include "journal.h"
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
 #include <SDL.h>
 #include <SDL_ttf.h>
 
@@ -11,19 +16,65 @@ namespace gui
     class Text
     {
     public:
+        class LineIterator
+        {
+        public:
+            LineIterator(const Text* text, int i)
+                : m_text(text), m_index(i) {}
+
+            std::string_view operator*() const { return m_text->line(m_index); }
+            LineIterator& operator++() { ++m_index; return *this; }
+
+            bool operator!=(const LineIterator& other) const { return m_index != other.m_index; }
+            bool operator==(const LineIterator& other) const { return m_index == other.m_index; }
+
+        private:
+            const Text* m_text;
+            int m_index;
+        };
+
+        struct Lines
+        {
+            LineIterator first, last;
+
+            LineIterator begin() const { return first; }
+            LineIterator end() const { return last; }
+        };
+
+
         Text() = default;
 
         Text(TTF_Font* font, SDL_Point pos, const std::string& contents, SDL_Point char_dimensions, SDL_Color col);
 
-        /* Inserts a character at m_contents[y][x]. */
+        /* Inserts a character at line y, column x.
+        * Inserting a new line splits line y at x.
+        */
         void insert(int x, int y, char c);
 
-        /* Erases a character at m_contents[y][x].
+        /* Erases a character at line y, column x.
         * Erases a new line like a normal character by default, but if erase_nl is set to false it will not erase new lines.
         */
         void erase(int x, int y, bool erase_nl = true);
 
-        void remove_line(int i) { m_contents.erase(m_contents.begin() + i); }
+        // erases count characters of line y starting from x, never erases new lines
+        void erase_section(int x, int y, int count);
+
+        /* Inserts text at pos (x is the column, y the line) as a single edit, new lines in text start new lines.
+        * Costs the same however many lines text spans.
+        */
+        void insert_text(SDL_Point pos, std::string_view text);
+        /* Erases everything between from and to as a single edit, new lines included.
+        * Which one comes first doesnt matter, positions past the end of a line are moved back to it.
+        */
+        void erase_range(SDL_Point from, SDL_Point to);
+        /* Copy of everything between from and to, same rules as erase_range.
+        * Only the range is looked at, the rest of the text is never pieced together.
+        */
+        std::string copy_range(SDL_Point from, SDL_Point to) const;
+
+        void remove_line(int i);
+        // removes the new line at the end of line i, appending line i + 1 onto it
+        void join_line(int i);
 
 
         // getters and setters
@@ -31,29 +82,94 @@ namespace gui
         // Get m_contents in string form.
         std::string str();
 
-        std::string get_line(int i) const { return i >= m_contents.size() ? "" : m_contents[i]; }
-        std::string& get_line_ref(int i) { return m_contents[i]; }
+        /* Copy of the contents that later edits dont affect, costs O(1).
+        * Empty while a mapped file is shown, those have nothing to save.
+        */
+        PieceTable snapshot() const { return m_contents; }
+
+        // copy of line i, prefer line() when the copy is not needed
+        std::string get_line(int i) const;
+
+        /* View of line i, empty if i is out of range.
+        * The view stays valid until the text is modified or line() is called again.
+        */
+        std::string_view line(int i) const;
+        /* View of count characters of line i starting at column first, only as much as is in the line.
+        * Same lifetime as line(), but only the section is looked at so it doesnt matter how long the line is.
+        */
+        std::string_view line(int i, int first, int count) const;
+        int line_length(int i) const;
+        int line_count() const;
+
+        // iterate over lines [first, last), for (std::string_view line : text.lines(first, last))
+        Lines lines(int first, int last) const;
+        Lines lines() const { return lines(0, line_count()); }
+
+        void set_contents(const std::vector<std::string>& contents);
+        // replaces everything with contents, a trailing new line doesnt start another line
+        void set_str(std::string_view contents);
+
+        void set_line(int i, const std::string& text);
+        void insert_line(int i);
+
+        /* Adds text to the end of the last line, new lines in text start new lines.
+        * Used while loading a file so it isnt recorded in the journal.
+        */
+        void append(std::string_view text);
+
+        // offsets are positions in str()
+        void insert_at(size_t offset, std::string_view text);
+        void erase_at(size_t offset, size_t length);
+        // amount of characters including new lines
+        size_t size() const;
 
-        std::vector<std::string> contents() const { return m_contents; }
-        void set_contents(const std::vector<std::string>& contents) { m_contents = contents; }
+        /* Shows a memory mapped file without reading it, the text becomes read only until the first modification
+        * which turns the mapping into the original buffer of the piece table.
+        */
+        void set_mapped(std::shared_ptr<MappedText> mapped);
+        bool read_only() const { return m_mapped != nullptr; }
+
+        // keeps finding lines in a mapped file, returns true once there is nothing left to index
+        bool index_lines(size_t budget);
 
-        void set_line(int i, const std::string& text) { m_contents[i] = text; }
-        void insert_line(int i) { m_contents.insert(m_contents.begin() + i, ""); }
+        // every edit from now on is recorded in journal, nullptr to stop recording
+        void set_journal(Journal* journal) { m_journal = journal; }
 
         SDL_Point char_dim() const { return m_char_dim; }
+        // changes every time the contents change
+        size_t version() const { return m_version; }
 
         TTF_Font* font() { return m_font; }
         SDL_Color color() const { return m_color; }
 
+    private:
+        // converts a line and column into an offset into m_contents
+        size_t offset(int x, int y) const;
+
+        // stops using the mapped file directly so the text can be modified
+        void make_editable();
+
+        // every edit goes through these so it ends up in the journal
+        void insert_contents(size_t offset, std::string_view text);
+        void erase_contents(size_t offset, size_t length);
+
     private:
         SDL_Rect m_rect;
 
         // character dimensions
         SDL_Point m_char_dim;
-        std::vector<std::string> m_contents;
+        PieceTable m_contents;
+        // holds lines that line() had to piece back together
+        mutable std::string m_line_buffer;
+
+        // set while showing a mapped file that hasnt been modified
+        std::shared_ptr<MappedText> m_mapped;
+        size_t m_version{ 0 };
         SDL_Color m_color;
 
         // non owning, dont free
         TTF_Font* m_font;
+        // non owning, dont free
+        Journal* m_journal{ nullptr };
     };
 }
@@ -1,6 +1,11 @@
 #include "text_entry.h"
+#include "line_index.h"
+#include <algorithm>
 #include <iostream>
 
+// ms the cursor stays on or off for
+#define BLINK_INTERVAL 530
+
 
 gui::TextEntry::TextEntry(SDL_Rect rect, SDL_Color bg_color, const Cursor& cursor, const Text& text)
     : m_rect(rect), m_cursor(cursor), m_bg_color(bg_color), m_text(text)
@@ -11,53 +16,73 @@ gui::TextEntry::TextEntry(SDL_Rect rect, SDL_Color bg_color, const Cursor& curso
     m_max_bounds = { m_rect.w / m_text.char_dim().x, m_rect.h / m_text.char_dim().y };
 
     m_text.set_contents({ "" });
-    m_cached_textures.emplace_back(nullptr);
 }
 
 
 void gui::TextEntry::render(SDL_Renderer* rend, bool show_cursor)
 {
+    RenderState state = render_state(show_cursor);
+
+    if (m_dirty || !(state == m_rendered_state))
+        m_blink_start = SDL_GetTicks();
+
+    m_dirty = false;
+    m_rendered_state = state;
+    m_rendered_blink_on = cursor_blink_on();
+
+    if (m_hidden)
+        return;
+
     SDL_SetRenderDrawColor(rend, m_bg_color.r, m_bg_color.g, m_bg_color.b, 255);
     SDL_RenderFillRect(rend, &m_rect);
 
-    if (show_cursor && m_cursor.display_pos(m_min_bounds).y >= m_rect.y)
-        m_cursor.render(rend, m_min_bounds);
+    // the column cut off by the right edge is still drawn, partly, and the cursor cant end up outside of the entry
+    SDL_RenderSetClipRect(rend, &m_rect);
 
-    if (m_cursor.display_char_pos(m_rect, m_min_bounds).y >= 0)
-        placeholder_at_cache(m_cursor.display_char_pos(m_rect, m_min_bounds).y);
+    if (show_cursor && m_rendered_blink_on && m_cursor.display_pos(m_min_bounds).y >= m_rect.y)
+        m_cursor.render(rend, m_min_bounds);
 
-    for (int i = 0; i < m_cached_textures.size(); ++i)
-    {
-        std::string line = m_text.get_line(i + m_min_bounds.y);
+    if (!m_atlas)
+        m_atlas = std::make_shared<GlyphAtlas>(rend, m_text.font(), m_text.char_dim());
 
-        if (m_min_bounds.x > (int)line.size()) // line is too far left to be seen
-            continue;
+    int last_line = std::min(m_max_bounds.y, m_text.line_count() - 1);
+    int visible_columns = m_rect.w / m_text.char_dim().x + 1;
 
-        // take the section of the string from the min bounds to either the end of the line if its visible, otherwise the max bound x
-        std::string visible = line.substr(m_min_bounds.x, std::min((int)line.size(), m_max_bounds.x + m_move_bounds_by) - m_min_bounds.x);
+    // every visible line goes into one batch, nothing gets rasterized unless a character is new
+    for (int i = 0; i <= last_line - m_min_bounds.y; ++i)
+    {
+        // only the columns on screen are looked at, scrolling sideways through a long line costs the same as through a short one
+        std::string_view visible = m_text.line(i + m_min_bounds.y, m_min_bounds.x, visible_columns);
 
         if (visible.empty())
             continue;
 
-        if (!m_cached_textures[i].get())
-        {
-            m_cached_textures[i] = std::unique_ptr<SDL_Texture, common::TextureDeleter>(common::render_text(rend, m_text.font(), visible.c_str(), m_text.color()));
-        }
-
-        SDL_Rect rect = {
-            m_rect.x,
-            m_rect.y + m_text.char_dim().y * i
-        };
-
-        if (m_cached_textures[i].get())
-        {
-            SDL_QueryTexture(m_cached_textures[i].get(), nullptr, nullptr, &rect.w, &rect.h);
-            SDL_RenderCopy(rend, m_cached_textures[i].get(), nullptr, &rect);
-        }
+        m_atlas->add_text(visible, m_rect.x, m_rect.y + m_text.char_dim().y * i, m_text.color());
     }
 
+    m_atlas->render();
+
     if (m_mode == EntryMode::HIGHLIGHT)
         draw_highlighted_areas(rend);
+
+    SDL_RenderSetClipRect(rend, nullptr);
+}
+
+
+bool gui::TextEntry::dirty(bool show_cursor)
+{
+    RenderState state = render_state(show_cursor);
+
+    if (m_dirty || !(state == m_rendered_state))
+        return true;
+
+    return show_cursor && !m_hidden && cursor_blink_on() != m_rendered_blink_on;
+}
+
+
+int gui::TextEntry::ms_until_blink()
+{
+    return BLINK_INTERVAL - (int)((SDL_GetTicks() - m_blink_start) % BLINK_INTERVAL);
 }
 
 
@@ -74,11 +99,6 @@ void gui::TextEntry::insert_char(char c)
 
     if (c == '\n')
     {
-        std::string line = m_text.get_line(cursor_coords.y);
-        std::string copied = line.substr(cursor_coords.x, line.size());
-
-        m_text.get_line_ref(cursor_coords.y).erase(cursor_coords.x, line.size());
-
         reset_bounds_x();
 
         // move the cursor to the beginning of the text box and down by 1 character
@@ -88,11 +108,6 @@ void gui::TextEntry::insert_char(char c)
         {
             move_bounds_characters(0, m_move_bounds_by);
         }
-
-        m_text.set_line(cursor_coords.y + 1, copied);
-        m_cached_textures.emplace_back(nullptr);
-
-        clear_cache();
     }
     else
     {
@@ -101,7 +116,6 @@ void gui::TextEntry::insert_char(char c)
         if (out_of_bounds())
         {
             move_bounds_characters(m_move_bounds_by, 0);
-            clear_cache();
         }
     }
 }
@@ -112,7 +126,6 @@ void gui::TextEntry::remove_char()
     if (m_mode == EntryMode::NORMAL)
     {
         SDL_Point cursor_coords = m_cursor.char_pos(m_rect);
-        std::string line = m_text.get_line(cursor_coords.y);
 
         if (cursor_coords.x == 0) // backspace onto previous line
         {
@@ -123,17 +136,11 @@ void gui::TextEntry::remove_char()
                     move_bounds_characters(0, std::min(cursor_coords.y - m_min_bounds.y - 1, cursor_coords.y - m_max_bounds.y + 1));
                 }
 
-                m_text.remove_line(cursor_coords.y);
+                int diff = m_text.line_length(cursor_coords.y - 1);
+                m_text.join_line(cursor_coords.y - 1);
 
-                m_cached_textures.erase(m_cached_textures.begin() + m_cursor.display_char_pos(m_rect, m_min_bounds).y);
-                m_cached_textures.emplace_back(nullptr);
-                placeholder_at_cache(std::max(cursor_coords.y - 1 - m_min_bounds.y, 0));
-
-                int diff = m_text.get_line(cursor_coords.y - 1).size();
                 move_cursor_characters(diff, -1);
 
-                m_text.get_line_ref(cursor_coords.y - 1).append(line);
-
                 if (out_of_bounds_x())
                 {
                     move_bounds_characters(diff - m_move_bounds_by, 0);
@@ -163,8 +170,87 @@ void gui::TextEntry::remove_char()
         erase_highlighted_section();
     }
 
-    if (m_max_bounds.y > m_text.contents().size())
-        move_bounds_characters(0, m_text.contents().size() - m_max_bounds.y);
+    if (m_max_bounds.y > m_text.line_count())
+        move_bounds_characters(0, m_text.line_count() - m_max_bounds.y);
+}
+
+
+void gui::TextEntry::insert_text(std::string_view text)
+{
+    if (text.empty())
+        return;
+
+    SDL_Point cursor_coords = m_cursor.char_pos(m_rect);
+    cursor_coords.x = std::min(cursor_coords.x, m_text.line_length(cursor_coords.y));
+
+    m_text.insert_text(cursor_coords, text);
+
+    int new_lines = (int)line_index::count_new_lines(text.data(), text.size());
+
+    if (new_lines == 0)
+        set_cursor_pos_characters(cursor_coords.x + (int)text.size(), cursor_coords.y);
+    else
+        set_cursor_pos_characters((int)(text.size() - text.rfind('\n') - 1), cursor_coords.y + new_lines);
+
+    scroll_to_cursor();
+}
+
+
+void gui::TextEntry::erase_range(SDL_Point from, SDL_Point to)
+{
+    if (to.y < from.y || (to.y == from.y && to.x < from.x))
+        std::swap(from, to);
+
+    // the cursor has to end up somewhere that exists
+    from.y = std::clamp(from.y, 0, m_text.line_count() - 1);
+    from.x = std::clamp(from.x, 0, m_text.line_length(from.y));
+
+    m_text.erase_range(from, to);
+
+    set_cursor_pos_characters(from.x, from.y);
+    scroll_to_cursor();
+}
+
+
+void gui::TextEntry::remove_chars(int count)
+{
+    SDL_Point to = m_cursor.char_pos(m_rect);
+    to.x = std::min(to.x, m_text.line_length(to.y));
+
+    SDL_Point from = to;
+
+    // counts characters, not bytes, a new line is one and so is every multibyte utf-8 character
+    while (count > 0)
+    {
+        if (from.x == 0)
+        {
+            if (from.y == 0)
+                break;
+
+            --count;
+            --from.y;
+            from.x = m_text.line_length(from.y);
+            continue;
+        }
+
+        // only the part of the line before from is looked at
+        std::string_view line = m_text.line(from.y, 0, from.x);
+
+        while (count > 0 && from.x > 0)
+        {
+            // continuation bytes are 10xxxxxx, the lead byte goes with them
+            do
+                --from.x;
+            while (from.x > 0 && ((unsigned char)line[from.x] & 0xC0) == 0x80);
+
+            --count;
+        }
+    }
+
+    erase_range(from, to);
+
+    if (m_max_bounds.y > m_text.line_count())
+        move_bounds_characters(0, m_text.line_count() - m_max_bounds.y);
 }
 
 
@@ -172,7 +258,7 @@ void gui::TextEntry::move_cursor_characters(int x, int y)
 {
     SDL_Point cursor_coords = m_cursor.char_pos(m_rect);
 
-    if (cursor_coords.x + x >= 0 && cursor_coords.y + y >= 0 && cursor_coords.y + y < m_text.contents().size())
+    if (cursor_coords.x + x >= 0 && cursor_coords.y + y >= 0 && cursor_coords.y + y < m_text.line_count())
         m_cursor.move_characters(x, y);
 }
 
@@ -180,7 +266,7 @@ void gui::TextEntry::move_cursor_characters(int x, int y)
 bool gui::TextEntry::jump_to_eol()
 {
     SDL_Point cursor_pos = m_cursor.char_pos(m_rect);
-    int eol = (int)m_text.get_line(cursor_pos.y).size();
+    int eol = m_text.line_length(cursor_pos.y);
 
     if (cursor_pos.x != eol)
     {
@@ -197,14 +283,13 @@ bool gui::TextEntry::jump_to_eol()
 bool gui::TextEntry::conditional_jump_to_eol()
 {
     SDL_Point cursor_pos = m_cursor.char_pos(m_rect);
-    std::string line = m_text.get_line(cursor_pos.y);
+    int line_length = m_text.line_length(cursor_pos.y);
 
-    if (cursor_pos.x > (int)line.size())
+    if (cursor_pos.x > line_length)
     {
         if (jump_to_eol())
         {
-            move_bounds_characters(((int)line.size() - m_min_bounds.x) - 3, 0);
-            clear_cache();
+            move_bounds_characters((line_length - m_min_bounds.x) - 3, 0);
         }
     }
 
@@ -226,42 +311,27 @@ void gui::TextEntry::move_bounds_characters(int x, int y)
     m_min_bounds.x += x;
     m_max_bounds.x += x;
 
-    bool shift = true;
-
     if (m_min_bounds.y + y >= 0)
     {
-        if (m_min_bounds.y + y < m_text.contents().size())
+        if (m_min_bounds.y + y < m_text.line_count())
         {
             m_min_bounds.y += y;
             m_max_bounds.y += y;
         }
         else
         {
-            shift_cache(m_text.contents().size() - m_min_bounds.y);
-            shift = false;
-
-            m_min_bounds.y += m_text.contents().size() - m_min_bounds.y;
-            m_max_bounds.y += m_text.contents().size() - m_min_bounds.y;
+            m_min_bounds.y += m_text.line_count() - m_min_bounds.y;
+            m_max_bounds.y += m_text.line_count() - m_min_bounds.y;
         }
     }
     else
     {
-        shift_cache(-m_min_bounds.y);
-        shift = false;
-
         m_max_bounds.y -= m_min_bounds.y;
         m_min_bounds.y = 0;
     }
 
     m_min_bounds.x = std::max(0, m_min_bounds.x);
     m_max_bounds.x = std::max(m_rect.w / m_text.char_dim().x, m_max_bounds.x);
-
-    if (shift)
-        shift_cache(y);
-
-    if (x != 0)
-        // no way to shift the cache horizontally, that would cause text to leak out of the box
-        clear_cache();
 }
 
 
@@ -309,65 +379,18 @@ bool gui::TextEntry::out_of_bounds_y()
 }
 
 
-void gui::TextEntry::clear_cache()
-{
-    for (auto& tex : m_cached_textures)
-    {
-        tex = nullptr;
-    }
-}
-
-
-void gui::TextEntry::placeholder_at_cache(int i)
-{
-    if (i >= m_cached_textures.size())
-        // just in case something goes wrong
-        m_cached_textures = std::vector<std::unique_ptr<SDL_Texture, common::TextureDeleter>>(i + 1);
-
-    m_cached_textures[i] = nullptr;
-}
-
-
-void gui::TextEntry::update_cache()
-{
-    m_cached_textures.clear();
-    m_cached_textures = std::vector<std::unique_ptr<SDL_Texture, common::TextureDeleter>>(std::max(std::min(m_max_bounds.y, (int)m_text.contents().size()) - m_min_bounds.y + 1, 1));
-}
-
-
-void gui::TextEntry::shift_cache(int y)
-{
-    if (y > 0) // shift downwards
-    {
-        for (int i = 0; i < y; ++i)
-        {
-            m_cached_textures.erase(m_cached_textures.begin());
-            m_cached_textures.emplace_back(nullptr);
-        }
-    }
-    else // shift upwards
-    {
-        for (int i = y; i < 0; ++i)
-        {
-            m_cached_textures.pop_back();
-            m_cached_textures.insert(m_cached_textures.begin(), nullptr);
-        }
-    }
-}
-
-
 void gui::TextEntry::mouse_down(int mx, int my)
 {
     move_cursor_to_click(mx, my);
 
     SDL_Point coords = m_cursor.char_pos(m_rect);
-    std::string line = m_text.get_line(coords.y);
+    int line_length = m_text.line_length(coords.y);
 
-    if (coords.x > line.size())
+    if (coords.x > line_length)
     {
         if (jump_to_eol())
         {
-            move_bounds_characters(line.size() - coords.x - m_move_bounds_by, 0);
+            move_bounds_characters(line_length - coords.x - m_move_bounds_by, 0);
         }
     }
 
@@ -389,9 +412,8 @@ void gui::TextEntry::move_cursor_to_click(int mx, int my)
         m_min_bounds.y + (int)((my - m_rect.y) / m_text.char_dim().y)
     };
 
-    // int cast to prevent coords.y from wrapping around since size() returns size_t
-    if (coords.y >= (int)m_text.contents().size())
-        coords.y = m_text.contents().size() - 1;
+    if (coords.y >= m_text.line_count())
+        coords.y = m_text.line_count() - 1;
 
     if (coords.y < 0)
         coords.y = 0;
@@ -401,9 +423,9 @@ void gui::TextEntry::move_cursor_to_click(int mx, int my)
     m_cursor.move_characters(coords.x - m_cursor.char_pos(m_rect).x, coords.y - m_cursor.char_pos(m_rect).y);
 
     SDL_Point cursor_pos = m_cursor.char_pos(m_rect);
-    std::string line = m_text.get_line(cursor_pos.y);
+    int line_length = m_text.line_length(cursor_pos.y);
 
-    if (cursor_pos.x > (int)line.size())
+    if (cursor_pos.x > line_length)
     {
         jump_to_eol();
     }
@@ -475,7 +497,7 @@ void gui::TextEntry::draw_highlighted_areas(SDL_Renderer* rend)
         SDL_Point cursor_coords = m_cursor.pos();
         SDL_Point highlight_coords = m_highlight_start.pos();
 
-        highlight_section(rend, cursor_char_coords.y, cursor_coords.x, m_rect.x + (int)m_text.get_line(cursor_char_coords.y).size() * m_text.char_dim().x);
+        highlight_section(rend, cursor_char_coords.y, cursor_coords.x, m_rect.x + m_text.line_length(cursor_char_coords.y) * m_text.char_dim().x);
         highlight_section(rend, highlight_char_coords.y, highlight_coords.x, m_rect.x);
     }
     else // cursor is lower than origin
@@ -489,7 +511,7 @@ void gui::TextEntry::draw_highlighted_areas(SDL_Renderer* rend)
         SDL_Point cursor_coords = m_cursor.pos();
         SDL_Point highlight_coords = m_highlight_start.pos();
 
-        highlight_section(rend, highlight_char_coords.y, highlight_coords.x, m_rect.x + (int)m_text.get_line(highlight_char_coords.y).size() * m_text.char_dim().x);
+        highlight_section(rend, highlight_char_coords.y, highlight_coords.x, m_rect.x + m_text.line_length(highlight_char_coords.y) * m_text.char_dim().x);
         highlight_section(rend, cursor_char_coords.y, cursor_coords.x, m_rect.x);
     }
 
@@ -502,16 +524,16 @@ void gui::TextEntry::highlight_line(SDL_Renderer* rend, int y_index)
     if ((y_index - m_min_bounds.y) * m_text.char_dim().y + m_rect.y < m_rect.y)
         return;
 
-    std::string line = m_text.get_line(y_index);
+    int line_length = m_text.line_length(y_index);
 
     // line is not visible
-    if (m_min_bounds.x > (int)line.size())
+    if (m_min_bounds.x > line_length)
         return;
 
     SDL_Rect rect = {
         m_rect.x,
         (y_index - m_min_bounds.y) * m_text.char_dim().y + m_rect.y,
-        std::min((int)line.size() * m_text.char_dim().x - m_min_bounds.x * m_text.char_dim().x, m_rect.w),
+        std::min(line_length * m_text.char_dim().x - m_min_bounds.x * m_text.char_dim().x, m_rect.w),
         m_text.char_dim().y
     };
 
@@ -527,9 +549,9 @@ void gui::TextEntry::highlight_section(SDL_Renderer* rend, int y_index, int x1,
     x1 -= m_min_bounds.x * m_text.char_dim().x;
     x2 -= m_min_bounds.x * m_text.char_dim().x;
 
-    std::string line = m_text.get_line(y_index);
+    int line_length = m_text.line_length(y_index);
 
-    if (m_min_bounds.x > (int)line.size())
+    if (m_min_bounds.x > line_length)
         return;
 
     if (x2 < x1)
@@ -551,91 +573,18 @@ void gui::TextEntry::highlight_section(SDL_Renderer* rend, int y_index, int x1,
 
 void gui::TextEntry::erase_highlighted_section()
 {
-    SDL_Point cursor_char_coords = m_cursor.char_pos(m_rect);
-    SDL_Point highlight_char_coords = m_highlight_start.char_pos(m_rect);
-
-    if (cursor_char_coords.y == highlight_char_coords.y) // single line highlight
-    {
-        int min = std::min(cursor_char_coords.x, highlight_char_coords.x);
-        int max = std::max(cursor_char_coords.x, highlight_char_coords.x);
-
-        m_text.get_line_ref(cursor_char_coords.y).erase(min, max - min);
-
-        if (cursor_char_coords.x > highlight_char_coords.x)
-        {
-            m_cursor.move_characters(highlight_char_coords.x - cursor_char_coords.x, 0);
-        }
-
-        cursor_char_coords = m_cursor.char_pos(m_rect);
-
-        if ((int)m_text.get_line_ref(cursor_char_coords.y).size() <= cursor_char_coords.x)
-            jump_to_eol();
-
-        stop_highlight();
-
-        if (out_of_bounds())
-            move_bounds_characters(cursor_char_coords.x - m_min_bounds.x, cursor_char_coords.y - m_min_bounds.y);
-    }
-    else if (cursor_char_coords.y < highlight_char_coords.y) // cursor above origin
-    {
-        for (int i = cursor_char_coords.y + 1; i < highlight_char_coords.y;)
-        {
-            m_text.remove_line(i);
-            --highlight_char_coords.y;
-        }
-
-        std::string& cursor_string = m_text.get_line_ref(cursor_char_coords.y);
-        cursor_string.erase(cursor_char_coords.x, (int)cursor_string.size() - cursor_char_coords.x);
-        
-        std::string& orig_string = m_text.get_line_ref(highlight_char_coords.y);
-        if (highlight_char_coords.x == (int)orig_string.size())
-            m_text.remove_line(highlight_char_coords.y);
-        else
-            orig_string.erase(0, highlight_char_coords.x);
-
-        if (out_of_bounds())
-            move_bounds_characters(cursor_char_coords.x - m_min_bounds.x, cursor_char_coords.y - m_min_bounds.y);
-
-        stop_highlight();
-        clear_cache();
-    }
-    else // cursor below origin
-    {
-        SDL_Point original_cursor_coords = m_cursor.char_pos(m_rect);
-
-        for (int i = highlight_char_coords.y + 1; i < cursor_char_coords.y;)
-        {
-            m_text.remove_line(i);
-            --cursor_char_coords.y;
-        }
-
-        std::string& orig_string = m_text.get_line_ref(highlight_char_coords.y);
-        orig_string.erase(highlight_char_coords.x, (int)orig_string.size() - highlight_char_coords.x);
-
-        std::string& cursor_string = m_text.get_line_ref(cursor_char_coords.y);
-        if (cursor_char_coords.x == (int)cursor_string.size())
-            m_text.remove_line(cursor_char_coords.y);
-        else
-            cursor_string.erase(0, cursor_char_coords.x);
-
-        stop_highlight();
-        clear_cache();
-
-        int diff_x = highlight_char_coords.x - original_cursor_coords.x;
-        int diff_y = highlight_char_coords.y - original_cursor_coords.y;
+    // one edit however many lines are highlighted, the cursor ends up where the highlight started
+    erase_range(m_cursor.char_pos(m_rect), m_highlight_start.char_pos(m_rect));
+    stop_highlight();
+}
 
-        move_cursor_characters(diff_x, diff_y);
 
-        if (out_of_bounds_x())
-        {
-            move_bounds_characters(diff_x + (diff_x > 0 ? 1 : -1) * m_move_bounds_by, 0);
-        }
+std::string gui::TextEntry::highlighted_text()
+{
+    if (m_mode != EntryMode::HIGHLIGHT)
+        return {};
 
-        if (out_of_bounds_y())
-        {
-            move_bounds_characters(0, diff_y - m_move_bounds_by);
-        }
-    }
+    return m_text.copy_range(m_cursor.char_pos(m_rect), m_highlight_start.char_pos(m_rect));
 }
 
 
@@ -651,9 +600,9 @@ void gui::TextEntry::resize_to(int w, int h)
         m_min_bounds.y + (int)(m_rect.h / m_text.char_dim().y)
     };
 
-    if (m_max_bounds.y >= m_text.contents().size())
+    if (m_max_bounds.y >= m_text.line_count())
     {
-        move_bounds_characters(0, m_text.contents().size() - m_max_bounds.y);
+        move_bounds_characters(0, m_text.line_count() - m_max_bounds.y);
     }
 
     m_cursor.move_pixels(
@@ -662,7 +611,13 @@ void gui::TextEntry::resize_to(int w, int h)
     );
 
     conditional_jump_to_eol();
-    update_cache();
+}
+
+
+void gui::TextEntry::scroll_x(int x)
+{
+    // the cursor stays where it is, like when scrolling vertically
+    move_bounds_characters(x, 0);
 }
 
 
@@ -670,7 +625,7 @@ void gui::TextEntry::scroll(int y)
 {
     if (y > 0) // scrolling down
     {
-        if (m_min_bounds.y + y < m_text.contents().size())
+        if (m_min_bounds.y + y < m_text.line_count())
         {
             move_bounds_characters(0, y);
         }
@@ -683,3 +638,56 @@ void gui::TextEntry::scroll(int y)
         }
     }
 }
+
+
+bool gui::TextEntry::RenderState::operator==(const RenderState& other) const
+{
+    return rect.x == other.rect.x && rect.y == other.rect.y && rect.w == other.rect.w && rect.h == other.rect.h
+        && min_bounds.x == other.min_bounds.x && min_bounds.y == other.min_bounds.y
+        && max_bounds.x == other.max_bounds.x && max_bounds.y == other.max_bounds.y
+        && cursor.x == other.cursor.x && cursor.y == other.cursor.y
+        && highlight_start.x == other.highlight_start.x && highlight_start.y == other.highlight_start.y
+        && mode == other.mode && text_version == other.text_version
+        && hidden == other.hidden && show_cursor == other.show_cursor;
+}
+
+
+gui::TextEntry::RenderState gui::TextEntry::render_state(bool show_cursor)
+{
+    return {
+        m_rect,
+        m_min_bounds, m_max_bounds,
+        m_cursor.pos(), m_highlight_start.pos(),
+        m_mode,
+        m_text.version(),
+        m_hidden, show_cursor
+    };
+}
+
+
+void gui::TextEntry::scroll_to_cursor()
+{
+    SDL_Point cursor_coords = m_cursor.char_pos(m_rect);
+
+    if (out_of_bounds_x())
+    {
+        if (cursor_coords.x < m_min_bounds.x)
+            move_bounds_characters(cursor_coords.x - m_min_bounds.x - m_move_bounds_by, 0);
+        else
+            move_bounds_characters(cursor_coords.x - m_max_bounds.x + m_move_bounds_by, 0);
+    }
+
+    if (out_of_bounds_y())
+    {
+        if (cursor_coords.y < m_min_bounds.y)
+            move_bounds_characters(0, cursor_coords.y - m_min_bounds.y);
+        else
+            move_bounds_characters(0, cursor_coords.y - m_max_bounds.y + 1);
+    }
+}
+
+
+bool gui::TextEntry::cursor_blink_on()
+{
+    return (SDL_GetTicks() - m_blink_start) / BLINK_INTERVAL % 2 == 0;
+}
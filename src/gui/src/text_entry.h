@@ -2,6 +2,7 @@
 #include "text.h"
 #include "cursor.h"
 #include "common.h"
+#include "glyph_atlas.h"
 #include <memory>
 
 
@@ -20,6 +21,15 @@ namespace gui
 
         void render(SDL_Renderer* rend, bool show_cursor = false);
 
+        /* True if render would draw something different from last time, including the cursor blinking.
+        * show_cursor should be whatever will be passed to render.
+        */
+        bool dirty(bool show_cursor);
+        // forces the next render, for changes the entry cant see itself
+        void invalidate() { m_dirty = true; }
+        // ms until the cursor blinks next
+        int ms_until_blink();
+
         bool check_clicked(int mx, int my);
 
         // adds a character to where the cursor currently is
@@ -27,6 +37,17 @@ namespace gui
         // removes a character where the cursor currently is
         void remove_char();
 
+        // inserts text where the cursor is as a single edit and moves the cursor to the end of it
+        void insert_text(std::string_view text);
+        /* Erases everything between from and to (measured in characters) as a single edit
+        * and moves the cursor to where the erased text started.
+        */
+        void erase_range(SDL_Point from, SDL_Point to);
+        /* Same as pressing backspace count times without a highlight, but as a single edit.
+        * count is in characters, a multibyte utf-8 character is erased as a whole.
+        */
+        void remove_chars(int count);
+
         void move_cursor_characters(int x, int y);
         // moves cursor to end of line, returns true if cursor has gone out of bounds
         bool jump_to_eol();
@@ -45,15 +66,6 @@ namespace gui
         bool out_of_bounds_x();
         bool out_of_bounds_y();
 
-        void clear_cache();
-        // marks m_cached_textures[i] to be re rendered
-        void placeholder_at_cache(int i);
-        // resize and clear the cache to fit current text size
-        void update_cache();
-        // move the cache vertically by y characters
-        void shift_cache(int y);
-
-
         void mouse_down(int mx, int my);
         void mouse_up();
 
@@ -72,11 +84,15 @@ namespace gui
         void highlight_section(SDL_Renderer* rend, int y_index, int x1, int x2);
         
         void erase_highlighted_section();
+        // copy of whatever is highlighted, empty if nothing is
+        std::string highlighted_text();
 
 
         void resize_to(int w, int h);
 
         void scroll(int y);
+        // scrolls sideways by x characters
+        void scroll_x(int x);
 
 
         void hide() { m_hidden = true; }
@@ -88,11 +104,31 @@ namespace gui
         Cursor cursor() { return m_cursor; }
         int move_bounds_by() { return m_move_bounds_by; }
         bool hidden() { return m_hidden; }
+        bool highlighting() { return m_mode == EntryMode::HIGHLIGHT; }
         SDL_Point min_bounds() { return m_min_bounds; }
         SDL_Point max_bounds() { return m_max_bounds; }
 
         void set_bounds_movement(int amount) { m_move_bounds_by = amount; }
 
+    private:
+        // everything render depends on except the cursor blinking
+        struct RenderState
+        {
+            SDL_Rect rect;
+            SDL_Point min_bounds, max_bounds;
+            SDL_Point cursor, highlight_start;
+            EntryMode mode;
+            size_t text_version;
+            bool hidden, show_cursor;
+
+            bool operator==(const RenderState& other) const;
+        };
+
+        RenderState render_state(bool show_cursor);
+        // moves the bounds just far enough for the cursor to be on screen
+        void scroll_to_cursor();
+        bool cursor_blink_on();
+
     private:
         SDL_Rect m_rect;
         Cursor m_cursor;
@@ -103,7 +139,8 @@ namespace gui
 
         Text m_text;
 
-        std::vector<std::unique_ptr<SDL_Texture, common::TextureDeleter>> m_cached_textures;
+        // created on the first render since it needs the renderer
+        std::shared_ptr<GlyphAtlas> m_atlas;
 
         int m_move_bounds_by{ 5 };
 
@@ -112,5 +149,11 @@ namespace gui
         EntryMode m_mode{ EntryMode::NORMAL };
 
         bool m_hidden{ false };
+
+        bool m_dirty{ true };
+        RenderState m_rendered_state{};
+        bool m_rendered_blink_on{ false };
+        // the cursor stays visible for a while after it moves or the text changes
+        Uint32 m_blink_start{ 0 };
     };
 }
@@ -0,0 +1,172 @@
+#include "text_search.h"
+#include <cstring>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define TEXT_SEARCH_X86
+#  include <immintrin.h>
+#endif
+
+// lets the simd functions be compiled without enabling avx2 for the whole program, the cpu is checked at runtime instead
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#  define TARGET_SSE2
+#  define TARGET_AVX2
+#else
+#  define TARGET_SSE2 __attribute__((target("sse2")))
+#  define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+using gui::line_index::Implementation;
+
+
+namespace
+{
+    int lowest_bit(uint64_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long i;
+
+        if (_BitScanForward(&i, (unsigned long)mask))
+            return (int)i;
+
+        _BitScanForward(&i, (unsigned long)(mask >> 32));
+        return (int)i + 32;
+#else
+        return __builtin_ctzll(mask);
+#endif
+    }
+
+
+    size_t find_scalar(const char* data, size_t length, std::string_view needle)
+    {
+        if (needle.size() > length)
+            return gui::text_search::npos;
+
+        const char* end = data + length - needle.size() + 1;
+
+        for (const char* p = data; p < end; ++p)
+        {
+            p = (const char*)memchr(p, needle[0], end - p);
+
+            if (!p)
+                break;
+
+            if (memcmp(p, needle.data(), needle.size()) == 0)
+                return p - data;
+        }
+
+        return gui::text_search::npos;
+    }
+
+
+    /* Both simd versions compare a block against the first character of needle, and the block needle.size() - 1
+    * further along against the last one. Only where both match is the whole needle compared,
+    * which in normal text is rare enough that the search runs at about the speed of reading the block.
+    */
+#if defined(TEXT_SEARCH_X86)
+    TARGET_SSE2 uint32_t candidates_sse2(const char* p, size_t last, __m128i first_char, __m128i last_char)
+    {
+        __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), first_char);
+        __m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + last)), last_char);
+
+        return (uint32_t)_mm_movemask_epi8(_mm_and_si128(a, b));
+    }
+
+
+    TARGET_SSE2 size_t find_sse2(const char* data, size_t length, std::string_view needle)
+    {
+        size_t last = needle.size() - 1;
+
+        const __m128i first_char = _mm_set1_epi8(needle[0]);
+        const __m128i last_char = _mm_set1_epi8(needle[last]);
+
+        size_t i = 0;
+
+        // 64 bytes at a time so blocks without a candidate are skipped with a single check
+        for (; i + last + 64 <= length; i += 64)
+        {
+            uint64_t mask = (uint64_t)candidates_sse2(data + i, last, first_char, last_char)
+                | (uint64_t)candidates_sse2(data + i + 16, last, first_char, last_char) << 16
+                | (uint64_t)candidates_sse2(data + i + 32, last, first_char, last_char) << 32
+                | (uint64_t)candidates_sse2(data + i + 48, last, first_char, last_char) << 48;
+
+            while (mask)
+            {
+                int bit = lowest_bit(mask);
+
+                if (memcmp(data + i + bit, needle.data(), needle.size()) == 0)
+                    return i + bit;
+
+                mask &= mask - 1;
+            }
+        }
+
+        size_t rest = find_scalar(data + i, length - i, needle);
+
+        return rest == gui::text_search::npos ? rest : i + rest;
+    }
+
+
+    TARGET_AVX2 uint32_t candidates_avx2(const char* p, size_t last, __m256i first_char, __m256i last_char)
+    {
+        __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), first_char);
+        __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + last)), last_char);
+
+        return (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(a, b));
+    }
+
+
+    TARGET_AVX2 size_t find_avx2(const char* data, size_t length, std::string_view needle)
+    {
+        size_t last = needle.size() - 1;
+
+        const __m256i first_char = _mm256_set1_epi8(needle[0]);
+        const __m256i last_char = _mm256_set1_epi8(needle[last]);
+
+        size_t i = 0;
+
+        for (; i + last + 64 <= length; i += 64)
+        {
+            uint64_t mask = (uint64_t)candidates_avx2(data + i, last, first_char, last_char)
+                | (uint64_t)candidates_avx2(data + i + 32, last, first_char, last_char) << 32;
+
+            while (mask)
+            {
+                int bit = lowest_bit(mask);
+
+                if (memcmp(data + i + bit, needle.data(), needle.size()) == 0)
+                    return i + bit;
+
+                mask &= mask - 1;
+            }
+        }
+
+        size_t rest = find_scalar(data + i, length - i, needle);
+
+        return rest == gui::text_search::npos ? rest : i + rest;
+    }
+#endif /* if defined(TEXT_SEARCH_X86) */
+}
+
+
+size_t gui::text_search::find(const char* data, size_t length, std::string_view needle)
+{
+    return find(data, length, needle, line_index::best_implementation());
+}
+
+
+size_t gui::text_search::find(const char* data, size_t length, std::string_view needle, Implementation impl)
+{
+    switch (impl)
+    {
+#if defined(TEXT_SEARCH_X86)
+    case Implementation::AVX2:
+        return find_avx2(data, length, needle);
+    case Implementation::SSE2:
+        return find_sse2(data, length, needle);
+#endif /* if defined(TEXT_SEARCH_X86) */
+    default:
+        return find_scalar(data, length, needle);
+    }
+}
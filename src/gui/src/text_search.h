@@ -0,0 +1,17 @@
+#pragma once
+#include "line_index.h"
+#include <string_view>
+#include <cstddef>
+
+
+/* Finding a string in big buffers, used by the project search.
+* Uses AVX2 or SSE2 when the cpu supports it, picked the same way as for line_index.
+*/
+namespace gui::text_search
+{
+    constexpr size_t npos = (size_t)-1;
+
+    // offset of the first place needle shows up in data, npos if it doesnt, needle cant be empty
+    size_t find(const char* data, size_t length, std::string_view needle);
+    size_t find(const char* data, size_t length, std::string_view needle, line_index::Implementation impl);
+}
@@ -0,0 +1,96 @@
+#include "texture_cache.h"
+#include <functional>
+
+
+gui::TextureCache::TextureCache(size_t budget_bytes)
+    : m_budget(budget_bytes)
+{
+}
+
+
+SDL_Texture* gui::TextureCache::get(SDL_Renderer* rend, TTF_Font* font, std::string_view text, SDL_Color color)
+{
+    if (text.empty())
+        return nullptr;
+
+    size_t h = hash(font, text, color);
+    auto it = m_lookup.find(h);
+
+    if (it != m_lookup.end())
+    {
+        Entry& e = *it->second;
+
+        if (e.text == text && e.font == font && e.color.r == color.r && e.color.g == color.g && e.color.b == color.b && e.color.a == color.a)
+        {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return e.texture.get();
+        }
+
+        // something else with the same hash, it gets replaced
+        m_used -= e.bytes;
+        m_entries.erase(it->second);
+        m_lookup.erase(it);
+    }
+
+    ++m_misses;
+
+    std::string s(text);
+    SDL_Texture* tex = common::render_text(rend, font, s.c_str(), color);
+
+    int w = 0, h_px = 0;
+    SDL_QueryTexture(tex, nullptr, nullptr, &w, &h_px);
+
+    size_t bytes = (size_t)w * h_px * 4;
+
+    m_entries.push_front({ h, std::move(s), font, color, std::unique_ptr<SDL_Texture, common::TextureDeleter>(tex), bytes });
+    m_lookup[h] = m_entries.begin();
+    m_used += bytes;
+
+    evict();
+
+    return tex;
+}
+
+
+void gui::TextureCache::set_budget(size_t budget_bytes)
+{
+    m_budget = budget_bytes;
+    evict();
+}
+
+
+void gui::TextureCache::clear()
+{
+    m_lookup.clear();
+    m_entries.clear();
+    m_used = 0;
+}
+
+
+size_t gui::TextureCache::hash(TTF_Font* font, std::string_view text, SDL_Color color)
+{
+    size_t h = std::hash<std::string_view>()(text);
+
+    auto combine = [&h](size_t v) {
+        h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    };
+
+    combine(std::hash<TTF_Font*>()(font));
+    combine(((size_t)color.r << 24) | ((size_t)color.g << 16) | ((size_t)color.b << 8) | color.a);
+
+    return h;
+}
+
+
+void gui::TextureCache::evict()
+{
+    // the newest texture is always kept, even if it alone is over the budget
+    while (m_used > m_budget && m_entries.size() > 1)
+    {
+        Entry& e = m_entries.back();
+
+        m_used -= e.bytes;
+        m_lookup.erase(e.hash);
+        m_entries.pop_back();
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "common.h"
+#include <string>
+#include <string_view>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+
+namespace gui
+{
+    /* Rendered text looked up by what it says and how it looks instead of by where it is on screen,
+    * so text that scrolls away and comes back is drawn from the same texture.
+    * Textures are kept until they take up more than the budget, then the least recently used are destroyed.
+    */
+    class TextureCache
+    {
+    public:
+        explicit TextureCache(size_t budget_bytes);
+
+        TextureCache(const TextureCache&) = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+
+        /* Texture of text rendered with font in color, only rasterized if it isnt cached already.
+        * The texture belongs to the cache and can be destroyed by the next call, so copy it before getting another one.
+        * Returns nullptr for empty text.
+        */
+        SDL_Texture* get(SDL_Renderer* rend, TTF_Font* font, std::string_view text, SDL_Color color);
+
+        // destroys textures right away if the new budget is smaller than what is used
+        void set_budget(size_t budget_bytes);
+        void clear();
+
+        size_t budget() const { return m_budget; }
+        // estimated texture memory in bytes
+        size_t used() const { return m_used; }
+        size_t size() const { return m_lookup.size(); }
+        // how many times text had to be rasterized
+        size_t misses() const { return m_misses; }
+
+    private:
+        struct Entry
+        {
+            size_t hash;
+
+            std::string text;
+            // non owning, dont free
+            TTF_Font* font;
+            SDL_Color color;
+
+            std::unique_ptr<SDL_Texture, common::TextureDeleter> texture;
+            size_t bytes;
+        };
+
+        static size_t hash(TTF_Font* font, std::string_view text, SDL_Color color);
+
+        void evict();
+
+    private:
+        // most recently used first
+        std::list<Entry> m_entries;
+        // hashes can collide, the entry is only used if it really is the same text
+        std::unordered_map<size_t, std::list<Entry>::iterator> m_lookup;
+
+        size_t m_budget;
+        size_t m_used{ 0 };
+        size_t m_misses{ 0 };
+    };
+}